@@ -31,6 +31,9 @@
 #ifndef AOP_H
 #define AOP_H
 
+#include <cstddef>
+#include <type_traits>
+
 namespace aop
 {
 
@@ -106,5 +109,82 @@ public:
         typedef typename TypeP::template Binding<Base<TypeP::template Binding>>::Type Type;
     };
 };
+
+/*
+* A list of aspects, as given to with<...>.
+*/
+template <template <class> class ... As>
+struct Aspects
+{};
+
+/*
+* Compile-time introspection. A decorated type is its aspects wrapped
+* around each other, outermost first: every layer is some Aspect<Inner>
+* while the base, taking a template, never is. Configuration parameters
+* are the static members of a layer, e.g. aspect_at<N, I>::Type::Precision.
+*/
+template <template <class> class A, template <class> class B>
+struct same_aspect : std::false_type
+{};
+
+template <template <class> class A>
+struct same_aspect<A, A> : std::true_type
+{};
+
+template <class N>
+struct aspect_count : std::integral_constant<std::size_t, 0>
+{};
+
+template <template <class> class Layer, class Inner>
+struct aspect_count<Layer<Inner>> : std::integral_constant<std::size_t, 1 + aspect_count<Inner>::value>
+{};
+
+template <class N, std::size_t I>
+struct aspect_at;
+
+template <template <class> class Layer, class Inner>
+struct aspect_at<Layer<Inner>, 0>
+{
+    typedef Layer<Inner> Type;
+};
+
+template <template <class> class Layer, class Inner, std::size_t I>
+struct aspect_at<Layer<Inner>, I> : aspect_at<Inner, I - 1>
+{};
+
+// Index of Aspect counting from the outermost layer, -1 when absent.
+template <class N, template <class> class Aspect>
+struct aspect_position : std::integral_constant<int, -1>
+{};
+
+template <template <class> class Layer, class Inner, template <class> class Aspect>
+struct aspect_position<Layer<Inner>, Aspect>
+    : std::integral_constant<int, same_aspect<Layer, Aspect>::value ? 0
+        : aspect_position<Inner, Aspect>::value < 0 ? -1 : 1 + aspect_position<Inner, Aspect>::value>
+{};
+
+template <class N, template <class> class Aspect>
+struct has_aspect : std::integral_constant<bool, aspect_position<N, Aspect>::value >= 0>
+{};
+
+// Whether Pred<Aspect>::value holds for every aspect of N.
+template <class N, template <template <class> class> class Pred>
+struct all_aspects : std::true_type
+{};
+
+template <template <class> class Layer, class Inner, template <template <class> class> class Pred>
+struct all_aspects<Layer<Inner>, Pred> : std::integral_constant<bool, Pred<Layer>::value && all_aspects<Inner, Pred>::value>
+{};
+
+// Aspects<...> such that with<...> of the same list gives N back.
+template <class N, class Found = Aspects<>>
+struct aspect_list
+{
+    typedef Found Type;
+};
+
+template <template <class> class Layer, class Inner, template <class> class ... Found>
+struct aspect_list<Layer<Inner>, Aspects<Found...>> : aspect_list<Inner, Aspects<Found..., Layer>>
+{};
 }
 #endif
@@ -162,6 +162,7 @@ struct RoundAspect
     public:
         typedef aop::AspectAopData< RoundAspect::Type, A> AopData;
         typedef typename AopData::Type FullType;
+        static const unsigned int Precision = PRECISION;
 
 #ifdef INHERITING_CTORS
         using A::A;
@@ -243,7 +244,7 @@ public:
     {}
 #endif
 
-    bool operator~() const
+    FullType operator~() const
     {
         return ~A::n;
     }
@@ -300,6 +301,13 @@ void bitwiseExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2
     std::cout << (a + ((b >>= 1) << 3)) << std::endl;
 }
 
+template <class N>
+void introspectionExample()
+{
+    std::cout << aop::aspect_count<N>::value << " " << aop::has_aspect<N, BitwiseAspect>::value << " "
+              << aop::aspect_position<N, ArithmeticAspect>::value << std::endl;
+}
+
 int main()
 {
 
@@ -316,5 +324,9 @@ int main()
     typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2>::Type, ArithmeticAspect>::Type FloatRoundNumber;
     sumExample<FloatRoundNumber>(1.339, 1.1233);
 
+    introspectionExample<IntegralNumber>();
+    introspectionExample<FloatRoundLogicalNumber>();
+    std::cout << aop::aspect_at<FloatRoundLogicalNumber, aop::aspect_position<FloatRoundLogicalNumber, RoundAspect<2>::Type>::value>::Type::Precision << std::endl;
+
     return 0;
 }
@@ -31,6 +31,9 @@
 #ifndef AOP_H
 #define AOP_H
 
+#include <cstddef>
+#include <type_traits>
+
 namespace aop
 {
 
@@ -71,5 +74,189 @@ public:
         typedef AspectsCombination<Base<AspectsCombination>> Type;
     };
 };
+
+/*
+* A compile-time operand, such as a shift count or a mask:
+* n << aop::Constant<3>().
+*/
+template <unsigned long long V>
+using Constant = std::integral_constant<unsigned long long, V>;
+
+/*
+* A list of aspects, as given to with<...>.
+*/
+template <template <class> class ... As>
+struct Aspects
+{
+    template <template <template <class> class> class Base>
+    using Decorated = typename Decorate<Base>::template with<As...>::Type;
+};
+
+/*
+* Compile-time introspection. A decorated type is its aspects wrapped
+* around each other, outermost first: every layer is some Aspect<Inner>
+* while the base, taking a template, never is. Configuration parameters
+* are the static members of a layer, e.g. aspect_at<N, I>::Type::Precision.
+*/
+template <template <class> class A, template <class> class B>
+struct same_aspect : std::false_type
+{};
+
+template <template <class> class A>
+struct same_aspect<A, A> : std::true_type
+{};
+
+template <class N>
+struct aspect_count : std::integral_constant<std::size_t, 0>
+{};
+
+template <template <class> class Layer, class Inner>
+struct aspect_count<Layer<Inner>> : std::integral_constant<std::size_t, 1 + aspect_count<Inner>::value>
+{};
+
+template <class N, std::size_t I>
+struct aspect_at;
+
+template <template <class> class Layer, class Inner>
+struct aspect_at<Layer<Inner>, 0>
+{
+    typedef Layer<Inner> Type;
+};
+
+template <template <class> class Layer, class Inner, std::size_t I>
+struct aspect_at<Layer<Inner>, I> : aspect_at<Inner, I - 1>
+{};
+
+// Index of Aspect counting from the outermost layer, -1 when absent.
+template <class N, template <class> class Aspect>
+struct aspect_position : std::integral_constant<int, -1>
+{};
+
+template <template <class> class Layer, class Inner, template <class> class Aspect>
+struct aspect_position<Layer<Inner>, Aspect>
+    : std::integral_constant<int, same_aspect<Layer, Aspect>::value ? 0
+        : aspect_position<Inner, Aspect>::value < 0 ? -1 : 1 + aspect_position<Inner, Aspect>::value>
+{};
+
+template <class N, template <class> class Aspect>
+struct has_aspect : std::integral_constant<bool, aspect_position<N, Aspect>::value >= 0>
+{};
+
+// Whether Pred<Aspect>::value holds for every aspect of N.
+template <class N, template <template <class> class> class Pred>
+struct all_aspects : std::true_type
+{};
+
+template <template <class> class Layer, class Inner, template <template <class> class> class Pred>
+struct all_aspects<Layer<Inner>, Pred> : std::integral_constant<bool, Pred<Layer>::value && all_aspects<Inner, Pred>::value>
+{};
+
+// Aspects<...> such that aspect_list<N>::Type::Decorated<Base> is N.
+template <class N, class Found = Aspects<>>
+struct aspect_list
+{
+    typedef Found Type;
+};
+
+template <template <class> class Layer, class Inner, template <class> class ... Found>
+struct aspect_list<Layer<Inner>, Aspects<Found...>> : aspect_list<Inner, Aspects<Found..., Layer>>
+{};
+
+/*
+* Merges two aspect lists into one keeping the relative order of each, so
+* an aspect that overrides another still wraps it. Aspects in both lists
+* appear once.
+*/
+template <class L, template <class> class Aspect>
+struct aspects_contain : std::false_type
+{};
+
+template <template <class> class Head, template <class> class ... Tail, template <class> class Aspect>
+struct aspects_contain<Aspects<Head, Tail...>, Aspect>
+    : std::integral_constant<bool, same_aspect<Head, Aspect>::value || aspects_contain<Aspects<Tail...>, Aspect>::value>
+{};
+
+template <template <class> class Head, class L>
+struct aspects_prepend;
+
+template <template <class> class Head, template <class> class ... As>
+struct aspects_prepend<Head, Aspects<As...>>
+{
+    typedef Aspects<Head, As...> Type;
+};
+
+template <class L, template <class> class Aspect>
+struct aspects_remove
+{
+    typedef L Type;
+};
+
+template <template <class> class Head, template <class> class ... Tail, template <class> class Aspect>
+struct aspects_remove<Aspects<Head, Tail...>, Aspect>
+{
+    typedef typename aspects_remove<Aspects<Tail...>, Aspect>::Type Rest;
+    typedef typename std::conditional<same_aspect<Head, Aspect>::value, Rest, typename aspects_prepend<Head, Rest>::Type>::type Type;
+};
+
+template <class L1, class L2>
+struct merge_aspects;
+
+template <class L2>
+struct merge_aspects<Aspects<>, L2>
+{
+    typedef L2 Type;
+};
+
+template <template <class> class H1, template <class> class ... T1>
+struct merge_aspects<Aspects<H1, T1...>, Aspects<>>
+{
+    typedef Aspects<H1, T1...> Type;
+};
+
+template <template <class> class H1, template <class> class ... T1, template <class> class H2, template <class> class ... T2>
+struct merge_aspects<Aspects<H1, T1...>, Aspects<H2, T2...>>
+{
+private:
+    typedef Aspects<H1, T1...> L1;
+    typedef Aspects<H2, T2...> L2;
+
+    // H1 only in the first list, H2 only in the second, or both shared.
+    struct TakeFirst
+    {
+        typedef typename aspects_prepend<H1, typename merge_aspects<Aspects<T1...>, L2>::Type>::Type Type;
+    };
+
+    struct TakeSecond
+    {
+        typedef typename aspects_prepend<H2, typename merge_aspects<L1, Aspects<T2...>>::Type>::Type Type;
+    };
+
+    struct TakeShared
+    {
+        typedef typename aspects_prepend<H1, typename merge_aspects<Aspects<T1...>, typename aspects_remove<L2, H1>::Type>::Type>::Type Type;
+    };
+
+public:
+    typedef typename std::conditional<!aspects_contain<L2, H1>::value, TakeFirst,
+        typename std::conditional<!aspects_contain<L1, H2>::value, TakeSecond, TakeShared>::type>::type::Type Type;
+};
+
+/*
+* Aspects add behaviour, not state, so a decorated value has exactly the
+* layout of its underlying value. Bulk facilities rely on that to read it.
+*/
+template <class N>
+const typename N::UnderlyingType& underlying(const N& number)
+{
+    static_assert(std::is_standard_layout<N>::value && sizeof(N) == sizeof(typename N::UnderlyingType),
+                  "decorated type is not layout compatible with its underlying type");
+    return *reinterpret_cast<const typename N::UnderlyingType*>(&number);
+}
+
+template <class N>
+typename N::UnderlyingType& underlying(N& number)
+{
+    return const_cast<typename N::UnderlyingType&>(underlying(static_cast<const N&>(number)));
+}
 }
 #endif
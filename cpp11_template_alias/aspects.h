@@ -0,0 +1,965 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+    
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+    
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef ASPECTS_H
+#define ASPECTS_H
+
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include "aop.h"
+
+//#define INHERITING_CTORS  as of g++ 6.4.3, inheriting ctors was not implemented
+
+template <typename _UnderlyingType>
+struct Number
+{
+    template <template <class> class A = aop::NullAspect>
+    class Type
+    {
+    public:
+        typedef _UnderlyingType UnderlyingType;
+        typedef A<Number::Type<A>> FullType;
+
+        Type(UnderlyingType n)
+            : n(n)
+        {}
+
+        friend std::ostream& operator<<(std::ostream& out, const Type& number)
+        {
+            return out << number.n;
+        }
+    protected:
+        UnderlyingType n;
+    };
+};
+
+/*
+* Raw operands: built-in values the stock aspects use as they are, with
+* no decorated temporary built around them.
+*/
+template <class T, class R>
+using EnableIfRaw = typename std::enable_if<std::is_arithmetic<T>::value, R>::type;
+
+template <class T, class R>
+using EnableIfRawIntegral = typename std::enable_if<std::is_integral<T>::value, R>::type;
+
+template <class A>
+class ArithmeticAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    ArithmeticAspect(typename A::UnderlyingType n)
+        : A(n)
+    {}
+
+    ArithmeticAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    FullType operator+(const FullType& other) const
+    {
+        FullType tmp(*this);
+        tmp += other;
+        return tmp;
+    }
+
+    FullType operator-(const FullType& other) const
+    {
+        FullType tmp(*this);
+        tmp -= other;
+        return tmp;
+    }
+
+    FullType operator+=(const FullType& other)
+    {
+        A::n += other.n;
+        return A::n;
+    }
+
+    FullType operator-=(const FullType& other)
+    {
+        A::n -= other.n;
+        return A::n;
+    }
+
+    template <class T>
+    EnableIfRaw<T, FullType> operator+(T other) const
+    {
+        FullType tmp(*this);
+        tmp += other;
+        return tmp;
+    }
+
+    template <class T>
+    EnableIfRaw<T, FullType> operator-(T other) const
+    {
+        FullType tmp(*this);
+        tmp -= other;
+        return tmp;
+    }
+
+    template <class T>
+    EnableIfRaw<T, FullType> operator+=(T other)
+    {
+        A::n += other;
+        return A::n;
+    }
+
+    template <class T>
+    EnableIfRaw<T, FullType> operator-=(T other)
+    {
+        A::n -= other;
+        return A::n;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, FullType> operator+(T raw, const FullType& other)
+    {
+        return other + raw;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, FullType> operator-(T raw, const FullType& other)
+    {
+        FullType tmp(raw);
+        tmp -= other;
+        return tmp;
+    }
+
+    // same for *, *=, /, /=
+};
+
+template <class A>
+class IncrementalAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    IncrementalAspect(typename A::UnderlyingType n)
+        : A(n)
+    {}
+
+    IncrementalAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    FullType operator++(int)
+    {
+        FullType tmp(*this);
+        operator++();
+        return tmp;
+    }
+
+    FullType operator++()
+    {
+        ++A::n;
+        return *this;
+    }
+
+    FullType operator--(int)
+    {
+        FullType tmp(*this);
+        operator--();
+        return tmp;
+    }
+
+    FullType operator--()
+    {
+        --A::n;
+        return *this;
+    }
+};
+
+/*
+* When a RoundAspect rounds: after every +, or once per expression chain.
+*/
+enum class Rounding
+{
+    Eager,
+    Deferred
+};
+
+template <unsigned int PRECISION>
+float roundTo(float f)
+{
+    const unsigned int e = std::pow(10, PRECISION);
+    return float(int(f * e)) / e;
+}
+
+/*
+* Configurable Aspect sumExample
+*/
+template <unsigned int PRECISION, Rounding MODE = Rounding::Eager>
+struct RoundAspect
+{
+    template <class A>
+    class Type : public A
+    {
+    public:
+        typedef typename A::FullType FullType;
+        static const unsigned int Precision = PRECISION;
+
+#ifdef INHERITING_CTORS
+        using A::A;
+#else
+        Type(typename A::UnderlyingType n)
+            : A(n)
+        {}
+
+        Type(const A& a)
+            : A(a)
+        {}
+#endif
+
+        FullType operator+(const FullType& other) const
+        {
+            return FullType(roundTo<PRECISION>(A::operator+(other).n));
+        }
+
+        template <class T>
+        EnableIfRaw<T, FullType> operator+(T other) const
+        {
+            return FullType(roundTo<PRECISION>(A::operator+(other).n));
+        }
+    };
+};
+
+/*
+* Deferred rounding: a + b + c yields an unrounded Sum, rounded once when
+* it becomes a FullType (construction, assignment), is printed or is
+* compared. A chain of n additions then truncates once, so its error is
+* below 10^-PRECISION plus the float error of the sum itself, where eager
+* rounding may lose up to n * 10^-PRECISION. To fuse a loop, accumulate in
+* a Sum: FullType::Sum total(zero); total = total + x; ...
+* The Sum adds through the + of the aspects below, like eager rounding.
+* - is never rounded on its own, as in eager mode, but after a + it
+* continues the Sum: (a + b) - c is rounded once, at the end.
+*/
+template <unsigned int PRECISION>
+struct RoundAspect<PRECISION, Rounding::Deferred>
+{
+    template <class A>
+    class Type : public A
+    {
+    public:
+        typedef typename A::FullType FullType;
+        typedef typename A::UnderlyingType UnderlyingType;
+        static const unsigned int Precision = PRECISION;
+
+#ifdef INHERITING_CTORS
+        using A::A;
+#else
+        Type(UnderlyingType n)
+            : A(n)
+        {}
+
+        Type(const A& a)
+            : A(a)
+        {}
+#endif
+
+        class Sum
+        {
+        public:
+            Sum(const FullType& value)
+                : value(value)
+            {}
+
+            Sum operator+(const FullType& other) const
+            {
+                return Sum(inner() + other, 0);
+            }
+
+            Sum operator+(const Sum& other) const
+            {
+                return Sum(inner() + other.value, 0);
+            }
+
+            template <class T>
+            EnableIfRaw<T, Sum> operator+(T other) const
+            {
+                return Sum(inner() + other, 0);
+            }
+
+            Sum operator-(const FullType& other) const
+            {
+                return Sum(inner() - other, 0);
+            }
+
+            template <class T>
+            EnableIfRaw<T, Sum> operator-(T other) const
+            {
+                return Sum(inner() - other, 0);
+            }
+
+            operator FullType() const
+            {
+                return FullType(roundTo<PRECISION>(aop::underlying(value)));
+            }
+
+            template <class T> bool operator==(const T& other) const { return FullType(*this) == other; }
+            template <class T> bool operator!=(const T& other) const { return FullType(*this) != other; }
+            template <class T> bool operator<(const T& other) const { return FullType(*this) < other; }
+            template <class T> bool operator<=(const T& other) const { return FullType(*this) <= other; }
+            template <class T> bool operator>(const T& other) const { return FullType(*this) > other; }
+            template <class T> bool operator>=(const T& other) const { return FullType(*this) >= other; }
+
+            friend std::ostream& operator<<(std::ostream& out, const Sum& sum)
+            {
+                return out << FullType(sum);
+            }
+
+        private:
+            Sum(const FullType& value, int)
+                : value(value)
+            {}
+
+            // The unrounded value seen as the aspects below this one.
+            const A& inner() const
+            {
+                return value;
+            }
+
+            FullType value;
+        };
+
+        Sum operator+(const FullType& other) const
+        {
+            return Sum(*static_cast<const FullType*>(this)) + other;
+        }
+
+        Sum operator+(const Sum& other) const
+        {
+            return other + *static_cast<const FullType*>(this);
+        }
+
+        template <class T>
+        EnableIfRaw<T, Sum> operator+(T other) const
+        {
+            return Sum(*static_cast<const FullType*>(this)) + other;
+        }
+    };
+};
+
+template <class A>
+class LogicalAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    LogicalAspect(typename A::UnderlyingType n)
+        : A(n)
+    {}
+
+    LogicalAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    bool operator!() const
+    {
+        return !A::n;
+    }
+
+    bool operator&&(const FullType& other) const
+    {
+        return A::n && other.n;
+    }
+
+    bool operator||(const FullType& other) const
+    {
+        return A::n || other.n;
+    }
+
+    template <class T>
+    EnableIfRaw<T, bool> operator&&(T other) const
+    {
+        return A::n && other;
+    }
+
+    template <class T>
+    EnableIfRaw<T, bool> operator||(T other) const
+    {
+        return A::n || other;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, bool> operator&&(T raw, const FullType& other)
+    {
+        return other && raw;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, bool> operator||(T raw, const FullType& other)
+    {
+        return other || raw;
+    }
+};
+
+template <class A>
+class BitwiseAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    BitwiseAspect(typename A::UnderlyingType n)
+        : A(n)
+    {}
+
+    BitwiseAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    FullType operator~() const
+    {
+        return ~A::n;
+    }
+
+    std::size_t popcount() const
+    {
+        return popcount(A::n, std::is_integral<typename A::UnderlyingType>());
+    }
+
+    // Index of the lowest set bit, the width of the value when none is set.
+    std::size_t findFirst() const
+    {
+        return findFirst(A::n, std::is_integral<typename A::UnderlyingType>());
+    }
+
+    // Number of set bits below position i.
+    std::size_t rank(std::size_t i) const
+    {
+        return rank(A::n, i, std::is_integral<typename A::UnderlyingType>());
+    }
+
+    FullType operator&(const FullType& mask) const
+    {
+        FullType result(*static_cast<const FullType*>(this));
+        result &= mask;
+        return result;
+    }
+
+    FullType operator|(const FullType& mask) const
+    {
+        FullType result(*static_cast<const FullType*>(this));
+        result |= mask;
+        return result;
+    }
+
+    FullType operator<<(const FullType& bitcount) const
+    {
+        return A::n << bitcount.n;
+    }
+
+    FullType operator>>(const FullType& bitcount) const
+    {
+        return A::n >> bitcount.n;
+    }
+
+    FullType& operator>>=(const FullType& bitcount)
+    {
+        A::n >>= bitcount.n;
+        return *static_cast<FullType*>(this);
+    }
+
+    FullType& operator&=(const FullType& mask)
+    {
+        A::n &= mask.n;
+        return *static_cast<FullType*>(this);
+    }
+
+    FullType& operator|=(const FullType& mask)
+    {
+        A::n |= mask.n;
+        return *static_cast<FullType*>(this);
+    }
+
+    template <class T>
+    EnableIfRawIntegral<T, FullType> operator&(T mask) const
+    {
+        return A::n & mask;
+    }
+
+    template <class T>
+    EnableIfRawIntegral<T, FullType> operator|(T mask) const
+    {
+        return A::n | mask;
+    }
+
+    template <class T>
+    EnableIfRawIntegral<T, FullType> operator<<(T bitcount) const
+    {
+        return A::n << bitcount;
+    }
+
+    template <class T>
+    EnableIfRawIntegral<T, FullType> operator>>(T bitcount) const
+    {
+        return A::n >> bitcount;
+    }
+
+    template <class T>
+    EnableIfRawIntegral<T, FullType&> operator>>=(T bitcount)
+    {
+        A::n >>= bitcount;
+        return *static_cast<FullType*>(this);
+    }
+
+    template <class T>
+    friend EnableIfRawIntegral<T, FullType> operator&(T mask, const FullType& other)
+    {
+        return other & mask;
+    }
+
+    template <class T>
+    friend EnableIfRawIntegral<T, FullType> operator|(T mask, const FullType& other)
+    {
+        return other | mask;
+    }
+
+    // Compile-time shift counts are checked against the width of the value.
+    template <unsigned long long BITS>
+    FullType operator<<(aop::Constant<BITS>) const
+    {
+        checkWidth<BITS>(std::is_integral<typename A::UnderlyingType>());
+        return A::n << BITS;
+    }
+
+    template <unsigned long long BITS>
+    FullType operator>>(aop::Constant<BITS>) const
+    {
+        checkWidth<BITS>(std::is_integral<typename A::UnderlyingType>());
+        return A::n >> BITS;
+    }
+
+    template <unsigned long long BITS>
+    FullType& operator>>=(aop::Constant<BITS>)
+    {
+        checkWidth<BITS>(std::is_integral<typename A::UnderlyingType>());
+        A::n >>= BITS;
+        return *static_cast<FullType*>(this);
+    }
+
+    // Compile-time masks of all zeros or all ones need no operation.
+    template <unsigned long long MASK>
+    FullType operator&(aop::Constant<MASK>) const
+    {
+        return MASK == 0 ? FullType(0) : MASK == ~0ULL ? FullType(A::n) : FullType(A::n & MASK);
+    }
+
+    template <unsigned long long MASK>
+    FullType operator|(aop::Constant<MASK>) const
+    {
+        return MASK == 0 ? FullType(A::n) : FullType(A::n | MASK);
+    }
+
+private:
+    template <unsigned long long BITS>
+    static void checkWidth(std::true_type)
+    {
+        static_assert(BITS < sizeof(typename A::UnderlyingType) * 8, "shift count exceeds the width of the value");
+    }
+
+    template <unsigned long long BITS>
+    static void checkWidth(std::false_type)
+    {}
+
+    // Built-in integers use the bit instructions directly, one 64 bit word
+    // at a time so that 128 bit integers are not truncated; wider values
+    // such as aop::Bitset provide count(), findFirst() and rank().
+    template <class T>
+    static unsigned long long word(T n, std::size_t i)
+    {
+        return static_cast<unsigned long long>(static_cast<typename std::make_unsigned<T>::type>(n) >> (64 * i));
+    }
+
+    template <class T>
+    static std::size_t popcount(T n, std::true_type)
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i * 8 < sizeof(T); ++i)
+            count += __builtin_popcountll(word(n, i));
+        return count;
+    }
+
+    template <class T>
+    static std::size_t popcount(const T& n, std::false_type)
+    {
+        return n.count();
+    }
+
+    template <class T>
+    static std::size_t findFirst(T n, std::true_type)
+    {
+        for (std::size_t i = 0; i * 8 < sizeof(T); ++i)
+            if (word(n, i) != 0)
+                return 64 * i + __builtin_ctzll(word(n, i));
+        return sizeof(T) * 8;
+    }
+
+    template <class T>
+    static std::size_t findFirst(const T& n, std::false_type)
+    {
+        return n.findFirst();
+    }
+
+    template <class T>
+    static std::size_t rank(T n, std::size_t i, std::true_type)
+    {
+        if (i >= sizeof(T) * 8)
+            return popcount(n, std::true_type());
+        std::size_t count = 0;
+        for (std::size_t w = 0; w < i / 64; ++w)
+            count += __builtin_popcountll(word(n, w));
+        return i % 64 == 0 ? count : count + __builtin_popcountll(word(n, i / 64) & ((1ULL << (i % 64)) - 1));
+    }
+
+    template <class T>
+    static std::size_t rank(const T& n, std::size_t i, std::false_type)
+    {
+        return n.rank(i);
+    }
+};
+
+template <class A>
+class ComparisonAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    ComparisonAspect(typename A::UnderlyingType n)
+        : A(n)
+    {}
+
+    ComparisonAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    bool operator==(const FullType& other) const
+    {
+        return A::n == other.n;
+    }
+
+    bool operator!=(const FullType& other) const
+    {
+        return A::n != other.n;
+    }
+
+    bool operator<(const FullType& other) const
+    {
+        return A::n < other.n;
+    }
+
+    bool operator<=(const FullType& other) const
+    {
+        return A::n <= other.n;
+    }
+
+    bool operator>(const FullType& other) const
+    {
+        return A::n > other.n;
+    }
+
+    bool operator>=(const FullType& other) const
+    {
+        return A::n >= other.n;
+    }
+
+    template <class T>
+    EnableIfRaw<T, bool> operator==(T other) const
+    {
+        return A::n == other;
+    }
+
+    template <class T>
+    EnableIfRaw<T, bool> operator!=(T other) const
+    {
+        return A::n != other;
+    }
+
+    template <class T>
+    EnableIfRaw<T, bool> operator<(T other) const
+    {
+        return A::n < other;
+    }
+
+    template <class T>
+    EnableIfRaw<T, bool> operator<=(T other) const
+    {
+        return A::n <= other;
+    }
+
+    template <class T>
+    EnableIfRaw<T, bool> operator>(T other) const
+    {
+        return A::n > other;
+    }
+
+    template <class T>
+    EnableIfRaw<T, bool> operator>=(T other) const
+    {
+        return A::n >= other;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, bool> operator==(T raw, const FullType& other)
+    {
+        return raw == other.n;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, bool> operator!=(T raw, const FullType& other)
+    {
+        return raw != other.n;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, bool> operator<(T raw, const FullType& other)
+    {
+        return raw < other.n;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, bool> operator<=(T raw, const FullType& other)
+    {
+        return raw <= other.n;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, bool> operator>(T raw, const FullType& other)
+    {
+        return raw > other.n;
+    }
+
+    template <class T>
+    friend EnableIfRaw<T, bool> operator>=(T raw, const FullType& other)
+    {
+        return raw >= other.n;
+    }
+};
+
+template <class A>
+class HashAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    HashAspect(typename A::UnderlyingType n)
+        : A(n)
+    {}
+
+    HashAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    // std::hash of integers is the identity: the MurmurHash3 finalizer
+    // spreads it so every bit of the result depends on every input bit.
+    std::size_t hash() const
+    {
+        std::uint64_t h = std::hash<typename A::UnderlyingType>()(A::n);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return std::size_t(h);
+    }
+};
+
+/*
+* Aspects that only add operators of their own and never redefine those
+* of another aspect. When a stack is made of these alone, algorithms may
+* bypass the operators and work on the underlying values directly.
+*/
+template <template <class> class Aspect>
+struct PlainAspect : std::false_type
+{};
+
+template <> struct PlainAspect<ArithmeticAspect> : std::true_type {};
+template <> struct PlainAspect<IncrementalAspect> : std::true_type {};
+template <> struct PlainAspect<LogicalAspect> : std::true_type {};
+template <> struct PlainAspect<BitwiseAspect> : std::true_type {};
+template <> struct PlainAspect<ComparisonAspect> : std::true_type {};
+template <> struct PlainAspect<HashAspect> : std::true_type {};
+
+template <class N, template <class> class Aspect>
+struct HasPlainAspect : std::integral_constant<bool, aop::has_aspect<N, Aspect>::value && aop::all_aspects<N, PlainAspect>::value>
+{};
+
+/*
+* Whether an aspect's operators are well formed on an underlying type:
+* bitwise operators are not defined on floating point values.
+*/
+template <template <class> class Aspect, class T>
+struct AspectSupports : std::true_type
+{};
+
+template <class T>
+struct AspectSupports<BitwiseAspect, T> : std::integral_constant<bool, !std::is_floating_point<T>::value>
+{};
+
+template <class L, class T>
+struct SupportedAspects
+{
+    typedef L Type;
+};
+
+template <template <class> class Head, template <class> class ... Tail, class T>
+struct SupportedAspects<aop::Aspects<Head, Tail...>, T>
+{
+    typedef typename SupportedAspects<aop::Aspects<Tail...>, T>::Type Rest;
+    typedef typename std::conditional<AspectSupports<Head, T>::value, typename aop::aspects_prepend<Head, Rest>::Type, Rest>::type Type;
+};
+
+/*
+* The type mixed operations between two decorated numbers yield: the
+* common underlying type with both aspect stacks merged, e.g. unsigned
+* int with ArithmeticAspect and float with RoundAspect<2> and
+* ArithmeticAspect give float with RoundAspect<2> and ArithmeticAspect.
+* Aspects the common type does not support are left out: BitwiseAspect
+* is dropped when the common type is floating point.
+*/
+template <class N1, class N2>
+struct CommonNumber
+{
+    typedef typename std::common_type<typename N1::UnderlyingType, typename N2::UnderlyingType>::type UnderlyingType;
+    typedef typename aop::merge_aspects<typename aop::aspect_list<N1>::Type, typename aop::aspect_list<N2>::Type>::Type Merged;
+    typedef typename SupportedAspects<Merged, UnderlyingType>::Type List;
+    typedef typename List::template Decorated<Number<UnderlyingType>::template Type> Type;
+};
+
+template <class N, class = void>
+struct IsDecorated : std::false_type
+{};
+
+template <class N>
+struct IsDecorated<N, typename std::enable_if<std::is_same<N, typename N::FullType>::value>::type> : std::true_type
+{};
+
+// Yields R, or the common number when R is void, if the common number has Aspect.
+template <class N1, class N2, template <class> class Aspect, class R = void,
+          bool = IsDecorated<N1>::value && IsDecorated<N2>::value && !std::is_same<N1, N2>::value>
+struct Heterogeneous
+{};
+
+template <class N1, class N2, template <class> class Aspect, class R>
+struct Heterogeneous<N1, N2, Aspect, R, true>
+    : std::enable_if<aop::has_aspect<typename CommonNumber<N1, N2>::Type, Aspect>::value,
+                     typename std::conditional<std::is_void<R>::value, typename CommonNumber<N1, N2>::Type, R>::type>
+{};
+
+/*
+* Mixed operations run the common number's operator on the underlying
+* values; only the result is a decorated value.
+*/
+template <class N1, class N2>
+typename Heterogeneous<N1, N2, ArithmeticAspect>::type operator+(const N1& a, const N2& b)
+{
+    typedef typename CommonNumber<N1, N2>::Type R;
+    return R(aop::underlying(a)) + aop::underlying(b);
+}
+
+template <class N1, class N2>
+typename Heterogeneous<N1, N2, ArithmeticAspect>::type operator-(const N1& a, const N2& b)
+{
+    typedef typename CommonNumber<N1, N2>::Type R;
+    return R(aop::underlying(a)) - aop::underlying(b);
+}
+
+template <class N1, class N2>
+typename Heterogeneous<N1, N2, ComparisonAspect, bool>::type operator==(const N1& a, const N2& b)
+{
+    typedef typename CommonNumber<N1, N2>::Type R;
+    return R(aop::underlying(a)) == aop::underlying(b);
+}
+
+template <class N1, class N2>
+typename Heterogeneous<N1, N2, ComparisonAspect, bool>::type operator!=(const N1& a, const N2& b)
+{
+    typedef typename CommonNumber<N1, N2>::Type R;
+    return R(aop::underlying(a)) != aop::underlying(b);
+}
+
+template <class N1, class N2>
+typename Heterogeneous<N1, N2, ComparisonAspect, bool>::type operator<(const N1& a, const N2& b)
+{
+    typedef typename CommonNumber<N1, N2>::Type R;
+    return R(aop::underlying(a)) < aop::underlying(b);
+}
+
+template <class N1, class N2>
+typename Heterogeneous<N1, N2, ComparisonAspect, bool>::type operator<=(const N1& a, const N2& b)
+{
+    typedef typename CommonNumber<N1, N2>::Type R;
+    return R(aop::underlying(a)) <= aop::underlying(b);
+}
+
+template <class N1, class N2>
+typename Heterogeneous<N1, N2, ComparisonAspect, bool>::type operator>(const N1& a, const N2& b)
+{
+    typedef typename CommonNumber<N1, N2>::Type R;
+    return R(aop::underlying(a)) > aop::underlying(b);
+}
+
+template <class N1, class N2>
+typename Heterogeneous<N1, N2, ComparisonAspect, bool>::type operator>=(const N1& a, const N2& b)
+{
+    typedef typename CommonNumber<N1, N2>::Type R;
+    return R(aop::underlying(a)) >= aop::underlying(b);
+}
+
+#endif
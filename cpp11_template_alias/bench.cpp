@@ -0,0 +1,1400 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "aspects.h"
+#include "bigint.h"
+#include "binary.h"
+#include "bitset.h"
+#include "cached.h"
+#include "compressed.h"
+#include "dynamic.h"
+#include "filter.h"
+#include "flatmap.h"
+#include "format.h"
+#include "intern.h"
+#include "matrix.h"
+#include "memo.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "pool.h"
+#include "scan.h"
+#include "sort.h"
+#include "sum.h"
+#include "window.h"
+
+static std::size_t globalAllocations = 0;
+static std::size_t globalBytes = 0;
+
+__attribute__((noinline)) void* operator new(std::size_t size)
+{
+    ++globalAllocations;
+    globalBytes += size;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+class Stopwatch
+{
+public:
+    Stopwatch()
+        : start(std::chrono::steady_clock::now()), allocations(globalAllocations)
+    {}
+
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::size_t allocated() const
+    {
+        return globalAllocations - allocations;
+    }
+
+private:
+    const std::chrono::steady_clock::time_point start;
+    const std::size_t allocations;
+};
+
+template <class T>
+void keep(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+static void report(const char* name, const Stopwatch& watch, std::size_t ops)
+{
+    std::cout << "  " << name << ": " << watch.seconds() * 1e9 / ops << " ns/op, "
+              << watch.allocated() << " allocations" << std::endl;
+}
+
+template <class N>
+void allocationBenchmark(const char* name, std::size_t ops)
+{
+    std::vector<N*> live(1024);
+    Stopwatch watch;
+    for (std::size_t i = 0; i < ops; i += live.size())
+    {
+        for (std::size_t j = 0; j < live.size(); ++j)
+            live[j] = new N(j);
+        for (std::size_t j = 0; j < live.size(); ++j)
+            delete live[j];
+    }
+    report(name, watch, ops);
+}
+
+template <class N>
+void requestBenchmark(const char* name, std::size_t requests, std::size_t opsPerRequest)
+{
+    const typename N::UnderlyingType digits("0123456789012345678901234567890123456789");
+    Stopwatch watch;
+    for (std::size_t r = 0; r < requests; ++r)
+    {
+        aop::ArenaScope request;
+        N total(digits);
+        for (std::size_t i = 0; i < opsPerRequest; ++i)
+            keep(total + N(digits));
+    }
+    report(name, watch, requests * opsPerRequest);
+}
+
+void poolBenchmark()
+{
+    std::cout << "pool: new/delete of decorated values" << std::endl;
+    allocationBenchmark<aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect>::Type>("global", 1 << 22);
+    allocationBenchmark<aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, PooledAspect>::Type>("pooled", 1 << 22);
+
+    std::cout << "pool: operator+ temporaries of heap backed values" << std::endl;
+    requestBenchmark<aop::Decorate<Number<std::string>::Type>::with<ArithmeticAspect>::Type>("global", 1000, 1000);
+    requestBenchmark<aop::Decorate<Number<aop::ArenaString>::Type>::with<ArithmeticAspect>::Type>("arena", 1000, 1000);
+}
+
+static void reportThroughput(const char* name, const Stopwatch& watch, std::size_t ops)
+{
+    std::cout << "  " << name << ": " << ops / watch.seconds() / 1e6 << " Mops/s" << std::endl;
+}
+
+void bigintBenchmark()
+{
+    __extension__ typedef unsigned __int128 Wide;
+    typedef aop::Decorate<BigNumber::Type>::with<ArithmeticAspect, BitwiseAspect, LogicalAspect>::Type BigIntegralNumber;
+
+    const std::size_t count = 1 << 20;
+    const std::size_t rounds = 16;
+    std::vector<Wide> wide(count);
+    std::vector<BigIntegralNumber> big;
+    big.reserve(count);
+    unsigned long long seed = 88172645463325252ULL;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        const unsigned long long high = seed >> 28;
+        wide[i] = (Wide(high) << 64) | seed;
+        big.push_back((aop::BigInt(high) << aop::BigInt(64)) | aop::BigInt(seed));
+    }
+
+    std::cout << "bigint: values below 2^100" << std::endl;
+    {
+        Stopwatch watch;
+        Wide total = 0;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < count; ++i)
+                total += wide[i];
+        keep(total);
+        reportThroughput("unsigned __int128 +", watch, rounds * count);
+    }
+    {
+        Stopwatch watch;
+        BigIntegralNumber total(0);
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < count; ++i)
+                total += big[i];
+        keep(total);
+        reportThroughput("BigNumber +=", watch, rounds * count);
+    }
+    {
+        Stopwatch watch;
+        Wide mask = 0;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < count; ++i)
+                mask |= wide[i] & wide[count - 1 - i];
+        keep(mask);
+        reportThroughput("unsigned __int128 & |", watch, rounds * count);
+    }
+    {
+        Stopwatch watch;
+        BigIntegralNumber mask(0);
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < count; ++i)
+                mask = mask | (big[i] & big[count - 1 - i]);
+        keep(mask);
+        reportThroughput("BigNumber & |", watch, rounds * count);
+    }
+    {
+        Stopwatch watch;
+        Wide total = 0;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < count; ++i)
+                total += wide[i] >> (i & 63);
+        keep(total);
+        reportThroughput("unsigned __int128 >>", watch, rounds * count);
+    }
+    {
+        const BigIntegralNumber shifts[] = { aop::BigInt(1), aop::BigInt(7), aop::BigInt(31), aop::BigInt(63) };
+        Stopwatch watch;
+        BigIntegralNumber total(0);
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < count; ++i)
+                total += big[i] >> shifts[i & 3];
+        keep(total);
+        reportThroughput("BigNumber >>", watch, rounds * count);
+    }
+    {
+        Stopwatch watch;
+        Wide mask = 0;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < count; ++i)
+                mask |= wide[i] << (i & 15);
+        keep(mask);
+        reportThroughput("unsigned __int128 <<", watch, rounds * count);
+    }
+    {
+        // Values below 2^100 shifted by up to 27 bits stay within two limbs.
+        const BigIntegralNumber shifts[] = { aop::BigInt(1), aop::BigInt(7), aop::BigInt(15), aop::BigInt(27) };
+        Stopwatch watch;
+        BigIntegralNumber mask(0);
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < count; ++i)
+                mask |= big[i] << shifts[i & 3];
+        keep(mask);
+        reportThroughput("BigNumber <<", watch, rounds * count);
+    }
+}
+
+static void reportBandwidth(const char* name, const Stopwatch& watch, std::size_t bytes)
+{
+    std::cout << "  " << name << ": " << bytes / watch.seconds() / 1e6 << " MB/s" << std::endl;
+}
+
+void binaryBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, IncrementalAspect, LogicalAspect, BitwiseAspect>::Type IntegralNumber;
+
+    const std::size_t count = 1 << 24;
+    const std::size_t bytes = count * sizeof(IntegralNumber);
+    std::vector<IntegralNumber> values;
+    values.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+        values.push_back(IntegralNumber(i * 2654435761u));
+
+    std::cout << "binary: " << count << " values" << std::endl;
+    {
+        Stopwatch watch;
+        std::ofstream out("bench_aop_binary.txt");
+        for (std::size_t i = 0; i < count; ++i)
+            out << values[i] << '\n';
+        out.close();
+        reportBandwidth("operator<< text write", watch, bytes);
+    }
+    {
+        Stopwatch watch;
+        aop::writeBinary("bench_aop_binary.bin", &values[0], count);
+        reportBandwidth("bulk write", watch, bytes);
+    }
+    {
+        Stopwatch watch;
+        aop::BinaryWriter<IntegralNumber> writer("bench_aop_binary.bin");
+        for (std::size_t i = 0; i < count; ++i)
+            writer.push(values[i]);
+        writer.close();
+        reportBandwidth("streaming write", watch, bytes);
+    }
+    {
+        Stopwatch watch;
+        const aop::MappedArray<IntegralNumber> mapped("bench_aop_binary.bin");
+        IntegralNumber total(0);
+        for (std::size_t i = 0; i < mapped.size(); ++i)
+            total += mapped[i];
+        keep(total);
+        reportBandwidth("mapped read and sum", watch, bytes);
+    }
+    std::remove("bench_aop_binary.txt");
+    std::remove("bench_aop_binary.bin");
+}
+
+template <class N>
+void formatBenchmark(const char* name, const std::vector<N>& values)
+{
+    std::cout << "format: " << name << std::endl;
+    std::string text;
+    {
+        Stopwatch watch;
+        std::ostringstream out;
+        for (std::size_t i = 0; i < values.size(); ++i)
+            out << values[i] << '\n';
+        text = out.str();
+        reportBandwidth("operator<<", watch, text.size());
+    }
+    {
+        Stopwatch watch;
+        std::string out;
+        aop::formatDelimited(&values[0], values.size(), out);
+        reportBandwidth("formatDelimited", watch, out.size());
+        text.swap(out);
+    }
+    {
+        Stopwatch watch;
+        std::istringstream in(text);
+        std::vector<N> parsed;
+        typename N::UnderlyingType n;
+        while (in >> n)
+            parsed.push_back(N(n));
+        keep(parsed);
+        reportBandwidth("operator>>", watch, text.size());
+    }
+    {
+        Stopwatch watch;
+        std::vector<N> parsed;
+        parsed.reserve(values.size());
+        aop::parseDelimited(text.data(), text.data() + text.size(), parsed);
+        keep(parsed);
+        reportBandwidth("parseDelimited", watch, text.size());
+    }
+}
+
+void formatBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, IncrementalAspect, LogicalAspect, BitwiseAspect>::Type IntegralNumber;
+    typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2>::Type, ArithmeticAspect>::Type FloatRoundNumber;
+
+    const std::size_t count = 1 << 22;
+    std::vector<IntegralNumber> integers;
+    std::vector<FloatRoundNumber> floats;
+    integers.reserve(count);
+    floats.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        integers.push_back(IntegralNumber(i * 2654435761u));
+        floats.push_back(FloatRoundNumber(float(i % 100000) / 7));
+    }
+    formatBenchmark("IntegralNumber", integers);
+    formatBenchmark("FloatRoundNumber", floats);
+}
+
+template <class N>
+void compressedBenchmark(const char* name, const std::vector<N>& values)
+{
+    const std::size_t rounds = 8;
+    const std::size_t bytes = rounds * values.size() * sizeof(N);
+    const aop::CompressedArray<N> compressed(&values[0], values.size());
+    std::size_t encodings[3] = { 0, 0, 0 };
+    for (std::size_t b = 0; b < compressed.blocks(); ++b)
+        ++encodings[compressed.encoding(b)];
+
+    std::cout << "compressed: " << name << ", ratio " << double(values.size() * sizeof(N)) / compressed.bytes()
+              << " (FOR " << encodings[0] << ", delta " << encodings[1] << ", vbyte " << encodings[2] << " blocks)" << std::endl;
+
+    const N mask(0xffff);
+    {
+        Stopwatch watch;
+        N total(0);
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t i = 0; i < values.size(); ++i)
+                total += values[i] & mask;
+        keep(total);
+        std::cout << "  raw sum of masks: " << bytes / watch.seconds() / 1e9 << " GB/s" << std::endl;
+    }
+    {
+        Stopwatch watch;
+        std::uint32_t buffer[aop::CompressedArray<N>::BlockSize];
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t b = 0; b < compressed.blocks(); ++b)
+            {
+                compressed.decodeBlock(b, buffer);
+                keep(buffer);
+            }
+        std::cout << "  decode: " << bytes / watch.seconds() / 1e9 << " GB/s" << std::endl;
+    }
+    {
+        Stopwatch watch;
+        N total(0);
+        for (std::size_t r = 0; r < rounds; ++r)
+            compressed.forEachBlock([&](const N* block, std::size_t n) {
+                for (std::size_t i = 0; i < n; ++i)
+                    total += block[i] & mask;
+            });
+        keep(total);
+        std::cout << "  decode and sum of masks: " << bytes / watch.seconds() / 1e9 << " GB/s" << std::endl;
+    }
+}
+
+void compressedBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, IncrementalAspect, LogicalAspect, BitwiseAspect>::Type IntegralNumber;
+
+    const std::size_t count = 1 << 24;
+    std::vector<IntegralNumber> sorted, narrow, skewed;
+    sorted.reserve(count);
+    narrow.reserve(count);
+    skewed.reserve(count);
+    unsigned int seed = 2463534242u;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        sorted.push_back(IntegralNumber(i * 3 + seed % 3));
+        narrow.push_back(IntegralNumber(1000000 + seed % 1000));
+        skewed.push_back(IntegralNumber(seed % 64 == 0 ? seed : seed % 200));
+    }
+    compressedBenchmark("sorted ids", sorted);
+    compressedBenchmark("narrow range", narrow);
+    compressedBenchmark("skewed", skewed);
+}
+
+void filterBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, IncrementalAspect, LogicalAspect, BitwiseAspect>::Type IntegralNumber;
+
+    const std::size_t count = 1 << 24;
+    std::vector<IntegralNumber> a, b;
+    a.reserve(count);
+    b.reserve(count);
+    unsigned int seed = 2463534242u;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        a.push_back(IntegralNumber(seed & 1));
+        b.push_back(IntegralNumber((seed >> 8) & 3));
+    }
+
+    std::cout << "filter: (a && b) || !a over " << count << " values" << std::endl;
+    {
+        Stopwatch watch;
+        std::vector<IntegralNumber> out;
+        out.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            if ((a[i] && b[i]) || !a[i])
+                out.push_back(b[i]);
+        keep(out);
+        reportThroughput("branchy scalar loop", watch, count);
+    }
+    {
+        Stopwatch watch;
+        const aop::Bitmask mask = aop::logicalAnd(&a[0], &b[0], count) | ~aop::truthMask(&a[0], count);
+        std::vector<IntegralNumber> out(b);
+        out.resize(aop::compact(&b[0], mask, &out[0]), IntegralNumber(0));
+        keep(out);
+        reportThroughput("bitmask and compact", watch, count);
+    }
+}
+
+void sortBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ComparisonAspect, ArithmeticAspect>::Type SortableNumber;
+
+    const std::size_t count = 1 << 22;
+    std::vector<SortableNumber> input;
+    input.reserve(count);
+    unsigned int seed = 2463534242u;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        input.push_back(SortableNumber(seed));
+    }
+
+    std::cout << "sort: " << count << " values" << std::endl;
+    std::vector<SortableNumber> values(input);
+    {
+        Stopwatch watch;
+        std::sort(values.begin(), values.end());
+        reportThroughput("std::sort", watch, count);
+    }
+    values = input;
+    {
+        Stopwatch watch;
+        aop::radixSort(&values[0], &values[0] + count);
+        reportThroughput("radixSort", watch, count);
+    }
+
+    const std::size_t Block = 16;
+    values = input;
+    {
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; i += Block)
+            std::sort(&values[i], &values[i] + Block);
+        reportThroughput("std::sort, blocks of 16", watch, count);
+    }
+    values = input;
+    {
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; i += Block)
+            aop::sort(&values[i], &values[i] + Block);
+        reportThroughput("aop::sort, blocks of 16", watch, count);
+    }
+
+    aop::radixSort(&values[0], &values[0] + count);
+    {
+        Stopwatch watch;
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            found += std::lower_bound(values.begin(), values.end(), input[i]) - values.begin();
+        keep(found);
+        reportThroughput("std::lower_bound", watch, count);
+    }
+    {
+        Stopwatch watch;
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            found += aop::branchlessLowerBound(&values[0], &values[0] + count, input[i]) - &values[0];
+        keep(found);
+        reportThroughput("branchlessLowerBound", watch, count);
+    }
+}
+
+template <class Map, class N>
+void mapBenchmark(const char* name, Map& map, const std::vector<N>& keys, const std::vector<N>& misses)
+{
+    std::cout << "hash: " << name << std::endl;
+    {
+        Stopwatch watch;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            map.insert(std::make_pair(keys[i], i));
+        reportThroughput("insert", watch, keys.size());
+    }
+    {
+        Stopwatch watch;
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            found += map.find(keys[i]) != map.end();
+        keep(found);
+        reportThroughput("lookup hit", watch, keys.size());
+    }
+    {
+        Stopwatch watch;
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < misses.size(); ++i)
+            found += map.find(misses[i]) != map.end();
+        keep(found);
+        reportThroughput("lookup miss", watch, misses.size());
+    }
+}
+
+template <class K, class V>
+struct FlatMapAdapter
+{
+    const V* end() const
+    {
+        return NULL;
+    }
+
+    void insert(const std::pair<K, V>& entry)
+    {
+        map.insert(entry.first, entry.second);
+    }
+
+    const V* find(const K& key) const
+    {
+        return map.find(key);
+    }
+
+    aop::FlatMap<K, V> map;
+};
+
+void hashBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<HashAspect, ComparisonAspect, ArithmeticAspect>::Type KeyNumber;
+
+    const std::size_t count = 1 << 22;
+    std::vector<KeyNumber> keys, misses;
+    keys.reserve(count);
+    misses.reserve(count);
+    unsigned int seed = 2463534242u;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        keys.push_back(KeyNumber(seed | 1));
+        misses.push_back(KeyNumber(seed & ~1u));
+    }
+
+    std::unordered_map<KeyNumber, std::size_t, aop::Hash<KeyNumber> > standard;
+    mapBenchmark("std::unordered_map", standard, keys, misses);
+    FlatMapAdapter<KeyNumber, std::size_t> flat;
+    mapBenchmark("aop::FlatMap", flat, keys, misses);
+}
+
+void parallelBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, IncrementalAspect, LogicalAspect, BitwiseAspect>::Type IntegralNumber;
+    typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2>::Type, ArithmeticAspect>::Type FloatRoundNumber;
+
+    const std::size_t count = 1 << 24;
+    std::vector<IntegralNumber> integers;
+    std::vector<FloatRoundNumber> floats;
+    integers.reserve(count);
+    floats.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        integers.push_back(IntegralNumber(i * 2654435761u));
+        floats.push_back(FloatRoundNumber(float(i % 3) / 100));
+    }
+
+    const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::size_t> threadCounts;
+    for (std::size_t threads = 1; threads < cores; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(cores);
+
+    std::cout << "parallel: " << count << " values, " << cores << " cores" << std::endl;
+    for (std::size_t t = 0; t < threadCounts.size(); ++t)
+    {
+        aop::parallel::ThreadPool pool(threadCounts[t]);
+        std::cout << "  " << threadCounts[t] << " threads" << std::endl;
+        {
+            Stopwatch watch;
+            const IntegralNumber sum = aop::parallel::reduce(pool, &integers[0], &integers[0] + count, IntegralNumber(0));
+            reportThroughput("  reduce +", watch, count);
+            keep(sum);
+        }
+        {
+            Stopwatch watch;
+            const IntegralNumber mask = aop::parallel::transform_reduce(pool, &integers[0], &integers[0] + count, IntegralNumber(0),
+                                                                        aop::parallel::BitwiseOr(),
+                                                                        [](const IntegralNumber& n) { return n & IntegralNumber(0xf0f0); });
+            reportThroughput("  transform_reduce & |", watch, count);
+            keep(mask);
+        }
+        {
+            Stopwatch watch;
+            const FloatRoundNumber sum = aop::parallel::reduce(pool, &floats[0], &floats[0] + count, FloatRoundNumber(0));
+            reportThroughput("  reduce + with RoundAspect", watch, count);
+            std::cout << "    sum " << sum << std::endl;
+        }
+    }
+}
+
+template <class N, class Op>
+void scanBenchmark(const char* name, const std::vector<N>& values, std::size_t rounds, Op op)
+{
+    const std::size_t count = values.size();
+    std::vector<N> out(values);
+    aop::parallel::ThreadPool pool;
+    std::cout << "scan: " << name << ", " << count << " values" << std::endl;
+    {
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+            aop::scanBlock(&values[0], count, &out[0], values[0], false, op, std::false_type());
+        reportThroughput("scalar", watch, rounds * count);
+    }
+    {
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+            aop::inclusive_scan(&values[0], &values[0] + count, &out[0], op);
+        reportThroughput("in-register", watch, rounds * count);
+    }
+    {
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+            aop::parallel::inclusive_scan(pool, &values[0], &values[0] + count, &out[0], op);
+        reportThroughput("two-pass parallel", watch, rounds * count);
+    }
+}
+
+void scanBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, IncrementalAspect, LogicalAspect, BitwiseAspect>::Type IntegralNumber;
+
+    std::vector<IntegralNumber> values;
+    for (std::size_t i = 0; i < (1 << 24); ++i)
+        values.push_back(IntegralNumber(i * 2654435761u));
+    const std::vector<IntegralNumber> cached(values.begin(), values.begin() + (1 << 12));
+
+    scanBenchmark("running total (+)", cached, 1 << 12, aop::parallel::Plus());
+    scanBenchmark("running total (+)", values, 1, aop::parallel::Plus());
+    scanBenchmark("running mask (|)", cached, 1 << 12, aop::parallel::BitwiseOr());
+    scanBenchmark("running mask (|)", values, 1, aop::parallel::BitwiseOr());
+}
+
+void windowBenchmark()
+{
+    typedef aop::Decorate<Number<int>::Type>::with<ComparisonAspect, ArithmeticAspect>::Type WindowNumber;
+    const std::size_t width = 1024;
+    const std::size_t ticks = 1 << 20;
+
+    std::vector<WindowNumber> ticksData;
+    for (std::size_t i = 0; i < ticks; ++i)
+        ticksData.push_back(WindowNumber(int((i * 2654435761u) >> 20)));
+
+    std::cout << "window: " << width << " wide, " << ticks << " ticks" << std::endl;
+    {
+        std::vector<WindowNumber> window;
+        WindowNumber sum(0), low(0), high(0);
+        Stopwatch watch;
+        for (std::size_t i = 0; i < ticks / 16; ++i)
+        {
+            window.push_back(ticksData[i]);
+            if (window.size() > width)
+                window.erase(window.begin());
+            sum = low = high = window[0];
+            for (std::size_t k = 1; k < window.size(); ++k)
+            {
+                sum += window[k];
+                if (window[k] < low)
+                    low = window[k];
+                if (high < window[k])
+                    high = window[k];
+            }
+        }
+        keep(sum);
+        keep(low);
+        keep(high);
+        reportThroughput("recompute", watch, ticks / 16);
+    }
+    {
+        aop::Window<WindowNumber, width> window;
+        WindowNumber sum(0), low(0), high(0);
+        Stopwatch watch;
+        for (std::size_t i = 0; i < ticks; ++i)
+        {
+            window.push(ticksData[i]);
+            sum = window.sum();
+            low = window.min();
+            high = window.max();
+            keep(sum);
+        }
+        keep(low);
+        keep(high);
+        reportThroughput("incremental", watch, ticks);
+    }
+}
+
+void pipelineBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, LogicalAspect, BitwiseAspect>::Type IngestNumber;
+    const std::size_t count = 1 << 20;
+
+    std::string text;
+    for (std::size_t i = 0; i < count; ++i)
+        text += std::to_string((i * 2654435761u) % 1000 < 300 ? 0 : i % 1000) + " ";
+
+    std::cout << "pipeline: parse, shift, filter, sum over " << count << " values" << std::endl;
+    {
+        std::istringstream input(text);
+        IngestNumber total(0);
+        unsigned int value;
+        Stopwatch watch;
+        while (input >> value)
+        {
+            const IngestNumber shifted = IngestNumber(value) << IngestNumber(1);
+            if (!!shifted)
+                total += shifted;
+        }
+        keep(total);
+        reportThroughput("sequential loop", watch, count);
+    }
+    for (std::size_t threads = 1; threads <= 4; threads *= 2)
+    {
+        std::istringstream input(text);
+        aop::pipeline::Channel<IngestNumber> parsed, shifted, kept;
+        IngestNumber total(0);
+        Stopwatch watch;
+        aop::pipeline::Pipeline pipeline(threads);
+        pipeline.spawn(aop::pipeline::parse(input, parsed));
+        pipeline.spawn(aop::pipeline::transform(parsed, shifted, [](const IngestNumber& n) { return n << IngestNumber(1); }));
+        pipeline.spawn(aop::pipeline::filter(shifted, kept));
+        pipeline.spawn(aop::pipeline::aggregate(kept, total, [](const IngestNumber& a, const IngestNumber& b) { return a + b; }));
+        pipeline.run();
+        keep(total);
+        reportThroughput(threads == 1 ? "pipeline, 1 thread" : threads == 2 ? "pipeline, 2 threads" : "pipeline, 4 threads", watch, count);
+    }
+}
+
+struct VirtualSemantics
+{
+    virtual ~VirtualSemantics() {}
+    virtual float add(float a, float b) const = 0;
+};
+
+template <class N>
+struct VirtualWrapper: VirtualSemantics
+{
+    float add(float a, float b) const
+    {
+        return aop::underlying(N(a) + N(b));
+    }
+};
+
+struct SumBatch
+{
+    template <class N>
+    float operator()(const N* values, std::size_t n) const
+    {
+        N total(0);
+        for (std::size_t i = 0; i < n; ++i)
+            total = total + values[i];
+        return aop::underlying(total);
+    }
+};
+
+void dynamicBenchmark()
+{
+    typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2>::Type, ArithmeticAspect>::Type RoundingNumber;
+    typedef aop::Decorate<Number<float>::Type>::with<ArithmeticAspect>::Type PlainNumber;
+    typedef aop::DynamicDecorate<Number<float>::Type>::among<aop::Aspects<RoundAspect<2>::Type, ArithmeticAspect>, aop::Aspects<ArithmeticAspect> > Semantics;
+    const std::size_t count = 1 << 12;
+    const std::size_t batches = 1 << 12;
+
+    std::vector<float> values;
+    for (std::size_t i = 0; i < count; ++i)
+        values.push_back(float(i % 100) / 64);
+
+    for (std::size_t tenant = 0; tenant < Semantics::Count; ++tenant)
+    {
+        std::cout << "dynamic decorate: " << (tenant == 0 ? "rounding" : "plain") << " tenant, " << count << " values per batch" << std::endl;
+        {
+            VirtualWrapper<RoundingNumber> rounding;
+            VirtualWrapper<PlainNumber> plain;
+            const VirtualSemantics* semantics = tenant == 0 ? static_cast<const VirtualSemantics*>(&rounding) : &plain;
+            keep(semantics);
+            Stopwatch watch;
+            for (std::size_t b = 0; b < batches; ++b)
+            {
+                float total = 0;
+                for (std::size_t i = 0; i < count; ++i)
+                    total = semantics->add(total, values[i]);
+                keep(total);
+            }
+            reportThroughput("virtual per operation", watch, batches * count);
+        }
+        {
+            std::size_t selected = tenant;
+            keep(selected);
+            const Semantics semantics(selected);
+            Stopwatch watch;
+            for (std::size_t b = 0; b < batches; ++b)
+                keep(semantics.apply(&values[0], count, SumBatch()));
+            reportThroughput("dispatch per batch", watch, batches * count);
+        }
+    }
+}
+
+/*
+* Stands for a costly pure conversion, such as a currency one.
+*/
+template <class A>
+class ConversionAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+
+    ConversionAspect(typename A::UnderlyingType n)
+        : A(n)
+    {}
+
+    ConversionAspect(const A& a)
+        : A(a)
+    {}
+
+    FullType operator+(const FullType& other) const
+    {
+        const double sum = A::operator+(other).n;
+        return FullType(float(std::log1p(std::exp(std::sin(sum / 64) + std::cbrt(sum))) * 64));
+    }
+};
+
+template <class N>
+void memoizeBenchmark(const char* name, const std::vector<float>& prices, const std::vector<float>& fees)
+{
+    N::clear();
+    float checksum = 0;
+    Stopwatch watch;
+    for (std::size_t i = 0; i < prices.size(); ++i)
+        checksum += aop::underlying(N(prices[i]) + N(fees[i]));
+    keep(checksum);
+    reportThroughput(name, watch, prices.size());
+    std::cout << "    hit rate: " << double(N::statistics().hits) / prices.size() << std::endl;
+}
+
+template <class N>
+void unmemoizedBenchmark(const char* name, const std::vector<float>& prices, const std::vector<float>& fees)
+{
+    float checksum = 0;
+    Stopwatch watch;
+    for (std::size_t i = 0; i < prices.size(); ++i)
+        checksum += aop::underlying(N(prices[i]) + N(fees[i]));
+    keep(checksum);
+    reportThroughput(name, watch, prices.size());
+}
+
+void memoizeBenchmark()
+{
+    typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2>::Type, ArithmeticAspect>::Type RoundingNumber;
+    typedef aop::Decorate<Number<float>::Type>::with<MemoizeAspect<16384>::Type, RoundAspect<2>::Type, ArithmeticAspect>::Type MemoizedRoundingNumber;
+    typedef aop::Decorate<Number<float>::Type>::with<ConversionAspect, ArithmeticAspect>::Type ConvertingNumber;
+    typedef aop::Decorate<Number<float>::Type>::with<MemoizeAspect<16384>::Type, ConversionAspect, ArithmeticAspect>::Type DirectMappedNumber;
+    typedef aop::Decorate<Number<float>::Type>::with<MemoizeAspect<16384, 4>::Type, ConversionAspect, ArithmeticAspect>::Type FourWayNumber;
+    const std::size_t count = 1 << 22;
+
+    std::vector<float> prices, fees;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::size_t r = (i * 2654435761u) >> 8;
+        prices.push_back(float(r % 1024) / 8);
+        fees.push_back(float(r / 1024 % 8) / 4);
+    }
+
+    std::cout << "memoize: +, 8192 recurring operand pairs" << std::endl;
+    unmemoizedBenchmark<RoundingNumber>("RoundAspect", prices, fees);
+    memoizeBenchmark<MemoizedRoundingNumber>("RoundAspect, memoized", prices, fees);
+    unmemoizedBenchmark<ConvertingNumber>("conversion", prices, fees);
+    memoizeBenchmark<DirectMappedNumber>("conversion, memoized direct mapped", prices, fees);
+    memoizeBenchmark<FourWayNumber>("conversion, memoized 4 way", prices, fees);
+}
+
+void mixedBenchmark()
+{
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, IncrementalAspect, LogicalAspect, BitwiseAspect>::Type IntegralNumber;
+    const std::size_t count = 1 << 24;
+
+    std::vector<unsigned int> raw;
+    for (std::size_t i = 0; i < count; ++i)
+        raw.push_back(unsigned(i * 2654435761u));
+    std::vector<IntegralNumber> values(raw.begin(), raw.end());
+
+    std::cout << "mixed operands: (x + 1) >> 3 & 0xff over " << count << " values" << std::endl;
+    {
+        unsigned int total = 0;
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; ++i)
+            total += (raw[i] + 1) >> 3 & 0xff;
+        keep(total);
+        reportThroughput("raw unsigned", watch, count);
+    }
+    {
+        IntegralNumber total(0);
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; ++i)
+            total += ((values[i] + IntegralNumber(1)) >> IntegralNumber(3)) & IntegralNumber(0xff);
+        keep(total);
+        reportThroughput("decorated operands", watch, count);
+    }
+    {
+        IntegralNumber total(0);
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; ++i)
+            total += ((values[i] + 1) >> 3) & 0xff;
+        keep(total);
+        reportThroughput("raw operands", watch, count);
+    }
+    {
+        IntegralNumber total(0);
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; ++i)
+            total += ((values[i] + 1) >> aop::Constant<3>()) & aop::Constant<0xff>();
+        keep(total);
+        reportThroughput("constant operands", watch, count);
+    }
+}
+
+void heterogeneousBenchmark()
+{
+    typedef aop::Decorate<Number<int>::Type>::with<ComparisonAspect, ArithmeticAspect>::Type Count;
+    typedef aop::Decorate<Number<float>::Type>::with<ComparisonAspect, ArithmeticAspect>::Type Amount;
+    typedef CommonNumber<Count, Amount>::Type Result;
+    const std::size_t count = 1 << 22;
+
+    std::vector<Count> counts;
+    std::vector<Amount> amounts;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        counts.push_back(Count(int(i % 1000)));
+        amounts.push_back(Amount(float(i % 777) / 8));
+    }
+
+    std::cout << "heterogeneous: int + float decorated numbers, " << count << " values" << std::endl;
+    {
+        Amount total(0);
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; ++i)
+            total += Amount(float(aop::underlying(counts[i]))) + amounts[i];
+        keep(total);
+        reportThroughput("unwrap and rewrap", watch, count);
+    }
+    {
+        Result total(0);
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; ++i)
+            total += counts[i] + amounts[i];
+        keep(total);
+        reportThroughput("common number", watch, count);
+    }
+}
+
+void roundingBenchmark()
+{
+    typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2>::Type, ArithmeticAspect>::Type FloatRoundNumber;
+    typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2, Rounding::Deferred>::Type, ArithmeticAspect>::Type FloatDeferredRoundNumber;
+    const std::size_t count = 1 << 16;
+    const std::size_t rounds = 256;
+
+    std::vector<float> raw;
+    double exact = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        raw.push_back(float(i % 997) / 997);
+        exact += raw.back();
+    }
+    const std::vector<FloatRoundNumber> eager(raw.begin(), raw.end());
+    const std::vector<FloatDeferredRoundNumber> deferred(raw.begin(), raw.end());
+
+    std::cout << "rounding: summation chain of " << count << " values, exact " << exact << std::endl;
+    {
+        FloatRoundNumber total(0);
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            total = FloatRoundNumber(0);
+            for (std::size_t i = 0; i < count; ++i)
+                total = total + eager[i];
+            keep(total);
+        }
+        reportThroughput("eager", watch, rounds * count);
+        std::cout << "    error: " << exact - aop::underlying(total) << std::endl;
+    }
+    {
+        FloatDeferredRoundNumber total(0);
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            FloatDeferredRoundNumber::Sum sum(FloatDeferredRoundNumber(0));
+            for (std::size_t i = 0; i < count; ++i)
+                sum = sum + deferred[i];
+            total = sum;
+            keep(total);
+        }
+        reportThroughput("deferred", watch, rounds * count);
+        std::cout << "    error: " << exact - aop::underlying(total) << std::endl;
+    }
+}
+
+void compensatedSumBenchmark()
+{
+    typedef aop::Decorate<Number<float>::Type>::with<CompensatedSumAspect, ArithmeticAspect>::Type FloatSumNumber;
+    const std::size_t count = 1 << 20;
+    const std::size_t rounds = 16;
+
+    std::vector<float> raw;
+    double exact = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        raw.push_back(float(i % 997) / 997 + 1000.0f * (i % 3 == 0));
+        exact += raw.back();
+    }
+    const std::vector<FloatSumNumber> values(raw.begin(), raw.end());
+
+    std::cout << "compensated sum: " << count << " floats, exact " << exact << std::endl;
+    {
+        float total = 0;
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            total = 0;
+            for (std::size_t i = 0; i < count; ++i)
+                total += raw[i];
+            keep(total);
+        }
+        reportThroughput("naive float", watch, rounds * count);
+        std::cout << "    error: " << exact - total << std::endl;
+    }
+    {
+        double total = 0;
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            total = 0;
+            for (std::size_t i = 0; i < count; ++i)
+                total += raw[i];
+            keep(total);
+        }
+        reportThroughput("double", watch, rounds * count);
+        std::cout << "    error: " << exact - float(total) << std::endl;
+    }
+    {
+        FloatSumNumber total(0);
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            FloatSumNumber::Accumulator sum;
+            for (std::size_t i = 0; i < count; ++i)
+                sum += values[i];
+            total = sum.total();
+            keep(total);
+        }
+        reportThroughput("accumulator", watch, rounds * count);
+        std::cout << "    error: " << exact - aop::underlying(total) << std::endl;
+    }
+    {
+        FloatSumNumber total(0);
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+        {
+            total = FloatSumNumber::sum(values.data(), count);
+            keep(total);
+        }
+        reportThroughput("pairwise", watch, rounds * count);
+        std::cout << "    error: " << exact - aop::underlying(total) << std::endl;
+    }
+}
+
+void bitsetBenchmark()
+{
+    const std::size_t Bits = 4096;
+    typedef aop::Decorate<BitsetNumber<Bits>::Type>::with<BitwiseAspect>::Type BitmapNumber;
+    const std::size_t count = 64;
+    const std::size_t rounds = 4096;
+
+    std::vector<BitmapNumber> bitmaps;
+    std::vector<std::bitset<Bits>> standard;
+    for (std::size_t b = 0; b < count; ++b)
+    {
+        aop::Bitset<Bits> bits;
+        for (std::size_t i = 0; i < Bits; ++i)
+            bits.set(i, (i * 2654435761u + b * 40503u) % 7 < 3);
+        bitmaps.push_back(BitmapNumber(bits));
+        standard.push_back(std::bitset<Bits>());
+        for (std::size_t i = 0; i < Bits; ++i)
+            standard.back()[i] = bits.test(i);
+    }
+
+    std::cout << "bitset: " << count << " bitmaps of " << Bits << " bits, (a & b) | ~c then popcount" << std::endl;
+    {
+        std::size_t total = 0;
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t b = 0; b + 2 < count; ++b)
+                total += ((standard[b] & standard[b + 1]) | ~standard[b + 2]).count();
+        keep(total);
+        reportThroughput("std::bitset", watch, rounds * (count - 2));
+    }
+    {
+        std::size_t total = 0;
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t b = 0; b + 2 < count; ++b)
+                total += ((bitmaps[b] & bitmaps[b + 1]) | ~bitmaps[b + 2]).popcount();
+        keep(total);
+        reportThroughput("decorated", watch, rounds * (count - 2));
+    }
+}
+
+template <std::size_t S>
+void matrixBenchmark(std::size_t rounds)
+{
+    typedef aop::Dense<float, S, S> Raw;
+    typedef typename aop::Decorate<Matrix<float, S, S>::template Type>::template with<ArithmeticAspect>::Type PlainMatrix;
+    typedef typename aop::Decorate<Matrix<float, S, S>::template Type>::template with<FusedAspect, ArithmeticAspect>::Type FusedMatrix;
+    const std::size_t count = 64;
+
+    std::vector<Raw> raw(count);
+    for (std::size_t m = 0; m < count; ++m)
+        for (std::size_t i = 0; i < S * S; ++i)
+            raw[m].data()[i] = float((m * 31 + i * 7) % 100) / 10;
+    const std::vector<PlainMatrix> plain(raw.begin(), raw.end());
+    const std::vector<FusedMatrix> fused(raw.begin(), raw.end());
+
+    std::cout << "matrix " << S << "x" << S << ": a + b - c + d" << std::endl;
+    {
+        Raw out;
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t m = 0; m + 3 < count; ++m)
+            {
+                for (std::size_t i = 0; i < S * S; ++i)
+                    out.data()[i] = raw[m].data()[i] + raw[m + 1].data()[i] - raw[m + 2].data()[i] + raw[m + 3].data()[i];
+                keep(out);
+            }
+        reportThroughput("naive loop", watch, rounds * (count - 3));
+    }
+    {
+        PlainMatrix out(0.0f);
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t m = 0; m + 3 < count; ++m)
+            {
+                out = plain[m] + plain[m + 1] - plain[m + 2] + plain[m + 3];
+                keep(out);
+            }
+        reportThroughput("decorated", watch, rounds * (count - 3));
+    }
+    {
+        FusedMatrix out(0.0f);
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t m = 0; m + 3 < count; ++m)
+            {
+                out = fused[m] + fused[m + 1] - fused[m + 2] + fused[m + 3];
+                keep(out);
+            }
+        reportThroughput("fused", watch, rounds * (count - 3));
+    }
+
+    std::cout << "matrix " << S << "x" << S << ": a * b" << std::endl;
+    {
+        Raw out;
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds / S; ++r)
+            for (std::size_t m = 0; m + 1 < count; ++m)
+            {
+                for (std::size_t i = 0; i < S; ++i)
+                    for (std::size_t j = 0; j < S; ++j)
+                    {
+                        float sum = 0;
+                        for (std::size_t k = 0; k < S; ++k)
+                            sum += raw[m](i, k) * raw[m + 1](k, j);
+                        out(i, j) = sum;
+                    }
+                keep(out);
+            }
+        reportThroughput("naive loop", watch, rounds / S * (count - 1));
+    }
+    {
+        Raw out;
+        Stopwatch watch;
+        for (std::size_t r = 0; r < rounds / S; ++r)
+            for (std::size_t m = 0; m + 1 < count; ++m)
+            {
+                out = raw[m] * raw[m + 1];
+                keep(out);
+            }
+        reportThroughput("blocked", watch, rounds / S * (count - 1));
+    }
+}
+
+template <class N>
+void internBenchmark(const char* name, const std::vector<aop::BigInt>& distinct, std::size_t count)
+{
+    std::cout << "  " << name << std::endl;
+    const std::size_t bytes = globalBytes;
+    std::vector<N> values;
+    values.reserve(count);
+    {
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; ++i)
+            values.push_back(N(distinct[i * 7 % distinct.size()]));
+        report("build", watch, count);
+        std::cout << "    " << double(globalBytes - bytes) / count << " bytes/value" << std::endl;
+    }
+    {
+        Stopwatch watch;
+        std::vector<N> copy(values);
+        keep(copy);
+        report("copy", watch, count);
+    }
+    {
+        std::size_t equal = 0;
+        Stopwatch watch;
+        for (std::size_t i = 0; i < count; ++i)
+            equal += values[i] == values[0];
+        keep(equal);
+        report("==", watch, count);
+    }
+    {
+        Stopwatch watch;
+        for (std::size_t i = 0; i + 1 < count; i += 2)
+        {
+            N sum = values[i] + values[i + 1];
+            keep(sum);
+        }
+        report("+", watch, count / 2);
+    }
+}
+
+void internBenchmark()
+{
+    typedef aop::Decorate<BigNumber::Type>::with<ArithmeticAspect, ComparisonAspect>::Type PlainBigNumber;
+    typedef aop::Decorate<InternNumber<aop::BigInt>::Type>::with<InternAspect, ArithmeticAspect, ComparisonAspect>::Type InternedBigNumber;
+    const std::size_t count = 1 << 20;
+
+    std::vector<aop::BigInt> distinct;
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        aop::BigInt value(i * 2654435761u + 1);
+        distinct.push_back(value <<= 192 + i);
+    }
+
+    std::cout << "intern: " << count << " values, " << distinct.size() << " distinct of about 256 bits" << std::endl;
+    internBenchmark<PlainBigNumber>("BigInt", distinct, count);
+    internBenchmark<InternedBigNumber>("interned", distinct, count);
+}
+
+// Number of decimal digits, through the decimal form: an expensive derived value.
+struct DecimalDigits
+{
+    typedef std::size_t Result;
+
+    template <class N>
+    std::size_t operator()(const N& n) const
+    {
+        std::ostringstream out;
+        out << n;
+        return out.str().size();
+    }
+};
+
+template <class N, class Read>
+void cachedBenchmark(const char* name, std::size_t mutations, std::size_t readsPerMutation, Read read)
+{
+    N n(aop::BigInt("340282366920938463463374607431768211457"));
+    const N step(aop::BigInt("18446744073709551629"));
+    std::size_t digits = 0;
+    Stopwatch watch;
+    for (std::size_t m = 0; m < mutations; ++m)
+    {
+        n += step;
+        for (std::size_t r = 0; r < readsPerMutation; ++r)
+            digits += read(n);
+    }
+    keep(digits);
+    reportThroughput(name, watch, mutations * readsPerMutation);
+}
+
+void cachedBenchmark()
+{
+    typedef aop::Decorate<BigNumber::Type>::with<ArithmeticAspect>::Type PlainBigNumber;
+    typedef aop::Decorate<BigNumber::Type>::with<CachedDerivedAspect<DecimalDigits>::Type, ArithmeticAspect>::Type CachedBigNumber;
+    const std::size_t mutations = 1 << 14;
+
+    for (std::size_t reads = 1; reads <= 16; reads *= 4)
+    {
+        std::cout << "cached derived: digits of a BigInt, " << reads << " reads per +=" << std::endl;
+        cachedBenchmark<PlainBigNumber>("recomputed", mutations, reads, [](const PlainBigNumber& n) { return DecimalDigits()(n); });
+        cachedBenchmark<CachedBigNumber>("cached", mutations, reads, [](const CachedBigNumber& n) { return n.derived(); });
+    }
+}
+
+int main()
+{
+    poolBenchmark();
+    bigintBenchmark();
+    binaryBenchmark();
+    formatBenchmark();
+    compressedBenchmark();
+    filterBenchmark();
+    sortBenchmark();
+    hashBenchmark();
+    parallelBenchmark();
+    scanBenchmark();
+    windowBenchmark();
+    pipelineBenchmark();
+    dynamicBenchmark();
+    memoizeBenchmark();
+    mixedBenchmark();
+    heterogeneousBenchmark();
+    roundingBenchmark();
+    compensatedSumBenchmark();
+    bitsetBenchmark();
+    matrixBenchmark<4>(65536);
+    matrixBenchmark<16>(8192);
+    matrixBenchmark<64>(1024);
+    internBenchmark();
+    cachedBenchmark();
+    return 0;
+}
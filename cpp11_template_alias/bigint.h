@@ -0,0 +1,513 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include <vector>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+#include "aspects.h"
+
+namespace aop
+{
+
+/*
+* Unsigned arbitrary precision integer. Values up to InlineLimbs limbs
+* (128 bits) live inside the object, bigger ones go to the heap.
+*/
+class BigInt
+{
+public:
+    typedef unsigned long long Limb;
+    static const std::size_t InlineLimbs = 2;
+    static const unsigned int LimbBits = 64;
+
+    BigInt()
+        : used(0), capacity(InlineLimbs)
+    {
+        local[0] = local[1] = 0;
+    }
+
+    template <class T>
+    BigInt(T value, typename std::enable_if<std::is_integral<T>::value>::type* = 0)
+        : used(value != 0), capacity(InlineLimbs)
+    {
+        local[0] = static_cast<unsigned long long>(value);
+        local[1] = 0;
+    }
+
+    BigInt(const char* decimal)
+        : used(0), capacity(InlineLimbs)
+    {
+        local[0] = local[1] = 0;
+        for (; *decimal >= '0' && *decimal <= '9'; ++decimal)
+            mulAdd(10, *decimal - '0');
+    }
+
+    BigInt(const BigInt& other)
+        : used(0), capacity(InlineLimbs)
+    {
+        assign(other);
+    }
+
+    BigInt(BigInt&& other)
+        : used(other.used), capacity(other.capacity)
+    {
+        if (other.isInline())
+        {
+            local[0] = other.local[0];
+            local[1] = other.local[1];
+        }
+        else
+        {
+            heap = other.heap;
+            other.capacity = InlineLimbs;
+            other.used = 0;
+        }
+    }
+
+    ~BigInt()
+    {
+        if (!isInline())
+            delete [] heap;
+    }
+
+    BigInt& operator=(const BigInt& other)
+    {
+        if (this != &other)
+            assign(other);
+        return *this;
+    }
+
+    BigInt& operator=(BigInt&& other)
+    {
+        if (this != &other)
+        {
+            this->~BigInt();
+            new (this) BigInt(static_cast<BigInt&&>(other));
+        }
+        return *this;
+    }
+
+    std::size_t size() const
+    {
+        return used;
+    }
+
+    bool isInline() const
+    {
+        return capacity == InlineLimbs;
+    }
+
+    Limb limb(std::size_t i) const
+    {
+        return i < used ? data()[i] : 0;
+    }
+
+    explicit operator bool() const
+    {
+        return used != 0;
+    }
+
+    bool operator!() const
+    {
+        return used == 0;
+    }
+
+    BigInt& operator+=(const BigInt& other)
+    {
+        if (isInline() && other.used <= InlineLimbs)
+        {
+            const Wide sum = wide() + other.wide();
+            if (sum >= wide())
+            {
+                setInline(Limb(sum), Limb(sum >> LimbBits));
+                return *this;
+            }
+        }
+
+        const std::size_t n = std::max(used, other.used);
+        reserve(n + 1);
+        Limb* d = data();
+        const Limb* o = other.data();
+        unsigned char carry = 0;
+        std::size_t i = 0;
+        for (; i < other.used; ++i)
+            carry = addCarry(carry, i < used ? d[i] : 0, o[i], d[i]);
+        for (; carry && i < n; ++i)
+            carry = addCarry(carry, d[i], 0, d[i]);
+        if (i >= used)
+            used = i;
+        if (carry)
+            d[used++] = 1;
+        return *this;
+    }
+
+    // Unsigned: the result of a - b with b > a is undefined.
+    BigInt& operator-=(const BigInt& other)
+    {
+        assert(!(*this < other));
+        Limb* d = data();
+        const Limb* o = other.data();
+        unsigned char borrow = 0;
+        std::size_t i = 0;
+        for (; i < other.used; ++i)
+            borrow = subBorrow(borrow, d[i], o[i], d[i]);
+        for (; borrow && i < used; ++i)
+            borrow = subBorrow(borrow, d[i], 0, d[i]);
+        trim();
+        return *this;
+    }
+
+    BigInt& operator++()
+    {
+        return *this += BigInt(1);
+    }
+
+    BigInt& operator--()
+    {
+        return *this -= BigInt(1);
+    }
+
+    // Word loops below are kept branch free so the compiler vectorizes them.
+    BigInt& operator&=(const BigInt& other)
+    {
+        if (isInline())
+        {
+            setInline(limb(0) & other.limb(0), limb(1) & other.limb(1));
+            return *this;
+        }
+
+        used = std::min(used, other.used);
+        Limb* d = data();
+        const Limb* o = other.data();
+        for (std::size_t i = 0; i < used; ++i)
+            d[i] &= o[i];
+        trim();
+        return *this;
+    }
+
+    BigInt& operator|=(const BigInt& other)
+    {
+        if (isInline() && other.used <= InlineLimbs)
+        {
+            setInline(limb(0) | other.limb(0), limb(1) | other.limb(1));
+            return *this;
+        }
+
+        reserve(other.used);
+        Limb* d = data();
+        const Limb* o = other.data();
+        for (std::size_t i = used; i < other.used; ++i)
+            d[i] = 0;
+        for (std::size_t i = 0; i < other.used; ++i)
+            d[i] |= o[i];
+        used = std::max(used, other.used);
+        return *this;
+    }
+
+    // Grows only when bits are carried out of the top limb; inline values
+    // whose result still fits in two limbs shift as one Wide.
+    BigInt& operator<<=(unsigned long long bits)
+    {
+        if (used == 0)
+            return *this;
+        if (isInline() && bits < 2 * LimbBits && (bits == 0 || wide() >> (2 * LimbBits - bits) == 0))
+        {
+            const Wide value = wide() << bits;
+            setInline(Limb(value), Limb(value >> LimbBits));
+            return *this;
+        }
+
+        const std::size_t limbs = bits / LimbBits;
+        const unsigned int shift = bits % LimbBits;
+        const Limb carry = shift == 0 ? 0 : data()[used - 1] >> (LimbBits - shift);
+        const std::size_t grown = used + limbs + (carry != 0);
+        reserve(grown);
+        Limb* d = data();
+        if (carry)
+            d[used + limbs] = carry;
+        if (shift == 0)
+            std::memmove(d + limbs, d, used * sizeof(Limb));
+        else
+        {
+            for (std::size_t i = used; i-- > 0; )
+                d[i + limbs] = (d[i] << shift) | (i > 0 ? d[i - 1] >> (LimbBits - shift) : 0);
+        }
+        std::memset(d, 0, limbs * sizeof(Limb));
+        used = grown;
+        return *this;
+    }
+
+    BigInt& operator>>=(unsigned long long bits)
+    {
+        if (isInline())
+        {
+            const Wide value = bits < 2 * LimbBits ? wide() >> bits : 0;
+            setInline(Limb(value), Limb(value >> LimbBits));
+            return *this;
+        }
+
+        const std::size_t limbs = bits / LimbBits;
+        const unsigned int shift = bits % LimbBits;
+        if (limbs >= used)
+        {
+            used = 0;
+            return *this;
+        }
+        Limb* d = data();
+        const std::size_t n = used - limbs;
+        if (shift == 0)
+            std::memmove(d, d + limbs, n * sizeof(Limb));
+        else
+        {
+            for (std::size_t i = 0; i + 1 < n; ++i)
+                d[i] = (d[i + limbs] >> shift) | (d[i + limbs + 1] << (LimbBits - shift));
+            d[n - 1] = d[n - 1 + limbs] >> shift;
+        }
+        used = n;
+        trim();
+        return *this;
+    }
+
+    BigInt& operator<<=(const BigInt& bits)
+    {
+        return *this <<= bits.limb(0);
+    }
+
+    BigInt& operator>>=(const BigInt& bits)
+    {
+        return *this >>= bits.limb(0);
+    }
+
+    friend BigInt operator+(BigInt a, const BigInt& b) { return a += b; }
+    friend BigInt operator-(BigInt a, const BigInt& b) { return a -= b; }
+    friend BigInt operator&(BigInt a, const BigInt& b) { return a &= b; }
+    friend BigInt operator|(BigInt a, const BigInt& b) { return a |= b; }
+    friend BigInt operator<<(BigInt a, const BigInt& bits) { return a <<= bits; }
+    friend BigInt operator>>(BigInt a, const BigInt& bits) { return a >>= bits; }
+
+    friend bool operator==(const BigInt& a, const BigInt& b)
+    {
+        return a.used == b.used && std::memcmp(a.data(), b.data(), a.used * sizeof(Limb)) == 0;
+    }
+
+    friend bool operator!=(const BigInt& a, const BigInt& b)
+    {
+        return !(a == b);
+    }
+
+    friend bool operator<(const BigInt& a, const BigInt& b)
+    {
+        if (a.used != b.used)
+            return a.used < b.used;
+        for (std::size_t i = a.used; i-- > 0; )
+            if (a.data()[i] != b.data()[i])
+                return a.data()[i] < b.data()[i];
+        return false;
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const BigInt& number)
+    {
+        static const Limb Base = 10000000000000000000ULL;
+        BigInt rest(number);
+        std::vector<Limb> chunks;
+        do
+            chunks.push_back(rest.divSmall(Base));
+        while (rest.used != 0);
+
+        out << chunks.back();
+        const char fill = out.fill('0');
+        for (std::size_t i = chunks.size() - 1; i-- > 0; )
+            out << std::setw(19) << chunks[i];
+        out.fill(fill);
+        return out;
+    }
+
+private:
+    __extension__ typedef unsigned __int128 Wide;
+
+    // Only meaningful while the value fits in the inline limbs.
+    Wide wide() const
+    {
+        return (Wide(limb(1)) << LimbBits) | limb(0);
+    }
+
+    static unsigned char addCarry(unsigned char carry, Limb a, Limb b, Limb& out)
+    {
+#if defined(__x86_64__)
+        return _addcarry_u64(carry, a, b, &out);
+#else
+        const Limb sum = a + b;
+        out = sum + carry;
+        return (sum < a) | (out < sum);
+#endif
+    }
+
+    static unsigned char subBorrow(unsigned char borrow, Limb a, Limb b, Limb& out)
+    {
+#if defined(__x86_64__)
+        return _subborrow_u64(borrow, a, b, &out);
+#else
+        const Limb diff = a - b;
+        out = diff - borrow;
+        return (a < b) | (diff < Limb(borrow));
+#endif
+    }
+
+    Limb* data()
+    {
+        return isInline() ? local : heap;
+    }
+
+    const Limb* data() const
+    {
+        return isInline() ? local : heap;
+    }
+
+    void reserve(std::size_t n)
+    {
+        if (n <= capacity)
+            return;
+        std::size_t grown = capacity * 2;
+        while (grown < n)
+            grown *= 2;
+        Limb* limbs = new Limb[grown];
+        std::memcpy(limbs, data(), used * sizeof(Limb));
+        if (!isInline())
+            delete [] heap;
+        heap = limbs;
+        capacity = grown;
+    }
+
+    void setInline(Limb low, Limb high)
+    {
+        local[0] = low;
+        local[1] = high;
+        used = high != 0 ? 2 : low != 0;
+    }
+
+    void assign(const BigInt& other)
+    {
+        if (isInline() && other.used <= InlineLimbs)
+        {
+            setInline(other.limb(0), other.limb(1));
+            return;
+        }
+        reserve(other.used);
+        std::memcpy(data(), other.data(), other.used * sizeof(Limb));
+        used = other.used;
+    }
+
+    void trim()
+    {
+        const Limb* d = data();
+        while (used != 0 && d[used - 1] == 0)
+            --used;
+    }
+
+    // Grows only when a limb is carried out, so a value that fits keeps
+    // its inline storage.
+    void mulAdd(Limb factor, Limb addend)
+    {
+        Limb* d = data();
+        Limb carry = addend;
+        for (std::size_t i = 0; i < used; ++i)
+        {
+            const Wide product = Wide(d[i]) * factor + carry;
+            d[i] = Limb(product);
+            carry = Limb(product >> LimbBits);
+        }
+        if (carry)
+        {
+            reserve(used + 1);
+            data()[used++] = carry;
+        }
+    }
+
+    Limb divSmall(Limb divisor)
+    {
+        Limb* d = data();
+        Limb remainder = 0;
+        for (std::size_t i = used; i-- > 0; )
+        {
+            const Wide current = (Wide(remainder) << LimbBits) | d[i];
+            d[i] = Limb(current / divisor);
+            remainder = Limb(current % divisor);
+        }
+        trim();
+        return remainder;
+    }
+
+    std::size_t used;
+    std::size_t capacity;
+    union
+    {
+        Limb local[InlineLimbs];
+        Limb* heap;
+    };
+};
+}
+
+namespace std
+{
+
+// Equal values have the same limbs, whether inline or on the heap.
+template <>
+struct hash<aop::BigInt>
+{
+    std::size_t operator()(const aop::BigInt& n) const
+    {
+        std::uint64_t h = n.size();
+        for (std::size_t i = 0; i < n.size(); ++i)
+        {
+            h = (h ^ n.limb(i)) * 0xff51afd7ed558ccdULL;
+            h ^= h >> 32;
+        }
+        return std::size_t(h);
+    }
+};
+}
+
+typedef Number<aop::BigInt> BigNumber;
+
+#endif
@@ -0,0 +1,306 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef BINARY_H
+#define BINARY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "aop.h"
+
+namespace aop
+{
+
+/*
+* On-disk layout: a fixed 64 byte header followed by the raw underlying
+* values, so a mapped file can be used in place as an array of N.
+*/
+struct BinaryHeader
+{
+    enum Kind { Unsigned = 0, Signed = 1, Float = 2 };
+
+    static const std::uint32_t CurrentVersion = 1;
+    static const std::size_t DataOffset = 64;
+
+    char magic[4];
+    std::uint32_t version;
+    std::uint8_t kind;
+    std::uint8_t size;
+    std::uint8_t littleEndian;
+    std::uint8_t reserved[5];
+    std::uint64_t fingerprint;
+    std::uint64_t count;
+    std::uint64_t dataOffset;
+    std::uint8_t padding[24];
+
+    template <class N>
+    static BinaryHeader describe()
+    {
+        typedef typename N::UnderlyingType T;
+        static_assert(std::is_arithmetic<T>::value, "only arithmetic underlying types can be stored");
+        static_assert(std::is_trivially_copyable<N>::value && sizeof(N) == sizeof(T),
+                      "decorated type is not layout compatible with its underlying type");
+
+        BinaryHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "AOPN", 4);
+        header.version = CurrentVersion;
+        header.kind = std::is_floating_point<T>::value ? Float : std::is_signed<T>::value ? Signed : Unsigned;
+        header.size = sizeof(T);
+        const std::uint16_t probe = 1;
+        header.littleEndian = *reinterpret_cast<const std::uint8_t*>(&probe);
+        header.fingerprint = fingerprintOf<N>();
+        header.dataOffset = DataOffset;
+        return header;
+    }
+
+    // FNV-1a of the mangled decorated type: identifies the aspect stack
+    // for files written and read by the same toolchain.
+    template <class N>
+    static std::uint64_t fingerprintOf()
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (const char* c = typeid(N).name(); *c; ++c)
+            hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ULL;
+        return hash;
+    }
+
+    bool matches(const BinaryHeader& expected) const
+    {
+        return std::memcmp(magic, expected.magic, 4) == 0
+            && version == expected.version
+            && kind == expected.kind
+            && size == expected.size
+            && littleEndian == expected.littleEndian
+            && fingerprint == expected.fingerprint
+            && dataOffset >= sizeof(BinaryHeader);
+    }
+};
+
+static_assert(sizeof(BinaryHeader) == BinaryHeader::DataOffset, "unexpected BinaryHeader padding");
+
+/*
+* Streaming writer: values are appended in bulk or one at a time (through
+* a small buffer), and the count in the header is patched on close().
+*/
+template <class N>
+class BinaryWriter
+{
+public:
+    explicit BinaryWriter(const std::string& path)
+        : file(std::fopen(path.c_str(), "wb")), header(BinaryHeader::describe<N>()), buffered(0)
+    {
+        buffer.resize(BufferSize * sizeof(N));
+        if (file == NULL)
+            throw std::runtime_error("cannot create " + path);
+        check(std::fwrite(&header, sizeof(header), 1, file) == 1);
+    }
+
+    // Finishes the file if close() was not called; errors are lost here,
+    // so call close() to see them.
+    ~BinaryWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void write(const N* values, std::size_t count)
+    {
+        flush();
+        check(std::fwrite(values, sizeof(N), count, file) == count);
+        header.count += count;
+    }
+
+    void push(const N& value)
+    {
+        if (buffered == BufferSize)
+            flush();
+        std::memcpy(&buffer[buffered++ * sizeof(N)], &value, sizeof(N));
+        ++header.count;
+    }
+
+    void close()
+    {
+        if (file == NULL)
+            return;
+        const bool written = drain()
+            && std::fseek(file, 0, SEEK_SET) == 0
+            && std::fwrite(&header, sizeof(header), 1, file) == 1;
+        const int result = std::fclose(file);
+        file = NULL;
+        check(written && result == 0);
+    }
+
+private:
+    static const std::size_t BufferSize = 64 * 1024 / sizeof(N);
+
+    BinaryWriter(const BinaryWriter&);
+    BinaryWriter& operator=(const BinaryWriter&);
+
+    void flush()
+    {
+        check(drain());
+    }
+
+    bool drain()
+    {
+        const bool ok = std::fwrite(&buffer[0], sizeof(N), buffered, file) == buffered;
+        buffered = 0;
+        return ok;
+    }
+
+    void check(bool ok)
+    {
+        if (!ok)
+            throw std::runtime_error("error writing binary array");
+    }
+
+    std::FILE* file;
+    BinaryHeader header;
+    std::vector<char> buffer;
+    std::size_t buffered;
+};
+
+template <class N>
+void writeBinary(const std::string& path, const N* values, std::size_t count)
+{
+    BinaryWriter<N> writer(path);
+    writer.write(values, count);
+    writer.close();
+}
+
+/*
+* Read-only memory mapping of a file written by BinaryWriter<N>.
+*/
+template <class N>
+class MappedArray
+{
+public:
+    typedef const N* const_iterator;
+
+    explicit MappedArray(const std::string& path)
+        : base(NULL), length(0), values(NULL), count(0)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path);
+
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && std::size_t(info.st_size) >= sizeof(BinaryHeader))
+        {
+            length = info.st_size;
+            base = ::mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (base == NULL || base == MAP_FAILED)
+        {
+            base = NULL;
+            throw std::runtime_error("cannot map " + path);
+        }
+
+        const BinaryHeader& header = *static_cast<const BinaryHeader*>(base);
+        if (!header.matches(BinaryHeader::describe<N>())
+            || header.dataOffset > length
+            || header.dataOffset % alignof(N) != 0
+            || header.count > (length - header.dataOffset) / sizeof(N))
+        {
+            unmap();
+            throw std::runtime_error(path + " does not hold an array of this decorated type");
+        }
+        values = reinterpret_cast<const N*>(static_cast<const char*>(base) + header.dataOffset);
+        count = header.count;
+        ::madvise(base, length, MADV_WILLNEED);
+    }
+
+    MappedArray(MappedArray&& other)
+        : base(other.base), length(other.length), values(other.values), count(other.count)
+    {
+        other.base = NULL;
+    }
+
+    ~MappedArray()
+    {
+        unmap();
+    }
+
+    std::size_t size() const
+    {
+        return count;
+    }
+
+    const N& operator[](std::size_t i) const
+    {
+        return values[i];
+    }
+
+    const_iterator begin() const
+    {
+        return values;
+    }
+
+    const_iterator end() const
+    {
+        return values + count;
+    }
+
+private:
+    MappedArray(const MappedArray&);
+    MappedArray& operator=(const MappedArray&);
+
+    void unmap()
+    {
+        if (base != NULL)
+            ::munmap(base, length);
+        base = NULL;
+    }
+
+    void* base;
+    std::size_t length;
+    const N* values;
+    std::size_t count;
+};
+}
+
+#endif
@@ -0,0 +1,266 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+#include "aspects.h"
+
+namespace aop
+{
+
+/*
+* Fixed width set of N bits, 64 per word. Bits past N are always 0. The
+* word loops have a constant trip count, so they compile to SIMD.
+*/
+template <std::size_t N>
+class Bitset
+{
+public:
+    static_assert(N > 0, "empty bitset");
+    static const std::size_t Words = (N + 63) / 64;
+
+    Bitset()
+        : words()
+    {}
+
+    // Negative values are sign extended across every word, as for
+    // built-in integers.
+    template <class T>
+    Bitset(T value, typename std::enable_if<std::is_integral<T>::value>::type* = 0)
+    {
+        const bool negative = std::is_signed<T>::value && static_cast<long long>(value) < 0;
+        for (std::size_t w = 1; w < Words; ++w)
+            words[w] = negative ? ~std::uint64_t(0) : 0;
+        words[0] = static_cast<unsigned long long>(value);
+        trim();
+    }
+
+    bool test(std::size_t i) const
+    {
+        return (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    Bitset& set(std::size_t i, bool value = true)
+    {
+        const std::uint64_t bit = std::uint64_t(1) << (i % 64);
+        words[i / 64] = value ? words[i / 64] | bit : words[i / 64] & ~bit;
+        return *this;
+    }
+
+    std::uint64_t word(std::size_t w) const
+    {
+        return words[w];
+    }
+
+    std::size_t count() const
+    {
+        std::size_t n = 0;
+        for (std::size_t w = 0; w < Words; ++w)
+            n += __builtin_popcountll(words[w]);
+        return n;
+    }
+
+    // Index of the lowest set bit, N when there is none.
+    std::size_t findFirst() const
+    {
+        for (std::size_t w = 0; w < Words; ++w)
+            if (words[w] != 0)
+                return w * 64 + __builtin_ctzll(words[w]);
+        return N;
+    }
+
+    // Number of set bits below position i.
+    std::size_t rank(std::size_t i) const
+    {
+        if (i >= N)
+            return count();
+        std::size_t n = 0;
+        for (std::size_t w = 0; w < i / 64; ++w)
+            n += __builtin_popcountll(words[w]);
+        return n + __builtin_popcountll(words[i / 64] & ((std::uint64_t(1) << (i % 64)) - 1));
+    }
+
+    explicit operator bool() const
+    {
+        std::uint64_t any = 0;
+        for (std::size_t w = 0; w < Words; ++w)
+            any |= words[w];
+        return any != 0;
+    }
+
+    bool operator!() const
+    {
+        return !bool(*this);
+    }
+
+    Bitset& operator&=(const Bitset& other)
+    {
+        for (std::size_t w = 0; w < Words; ++w)
+            words[w] &= other.words[w];
+        return *this;
+    }
+
+    Bitset& operator|=(const Bitset& other)
+    {
+        for (std::size_t w = 0; w < Words; ++w)
+            words[w] |= other.words[w];
+        return *this;
+    }
+
+    Bitset operator~() const
+    {
+        Bitset result((Uninitialized()));
+        for (std::size_t w = 0; w < Words; ++w)
+            result.words[w] = ~words[w];
+        result.trim();
+        return result;
+    }
+
+    Bitset& operator<<=(unsigned long long bits)
+    {
+        if (bits >= N)
+            return *this = Bitset();
+        const std::size_t shift = bits / 64;
+        const unsigned int offset = bits % 64;
+        for (std::size_t w = Words; w-- > shift; )
+        {
+            const std::uint64_t low = w > shift && offset != 0 ? words[w - shift - 1] >> (64 - offset) : 0;
+            words[w] = (words[w - shift] << offset) | low;
+        }
+        for (std::size_t w = 0; w < shift; ++w)
+            words[w] = 0;
+        trim();
+        return *this;
+    }
+
+    Bitset& operator>>=(unsigned long long bits)
+    {
+        if (bits >= N)
+            return *this = Bitset();
+        const std::size_t shift = bits / 64;
+        const unsigned int offset = bits % 64;
+        for (std::size_t w = 0; w + shift < Words; ++w)
+        {
+            const std::uint64_t high = w + shift + 1 < Words && offset != 0 ? words[w + shift + 1] << (64 - offset) : 0;
+            words[w] = (words[w + shift] >> offset) | high;
+        }
+        for (std::size_t w = Words - shift; w < Words; ++w)
+            words[w] = 0;
+        return *this;
+    }
+
+    // A shift count held in a bitset is its lowest word; any higher bit
+    // makes it at least 2^64, which shifts everything out.
+    Bitset& operator<<=(const Bitset& bits)
+    {
+        return bits.highWords() ? *this = Bitset() : *this <<= bits.words[0];
+    }
+
+    Bitset& operator>>=(const Bitset& bits)
+    {
+        return bits.highWords() ? *this = Bitset() : *this >>= bits.words[0];
+    }
+
+    // Results are written once, not copied from an operand and updated.
+    friend Bitset operator&(const Bitset& a, const Bitset& b)
+    {
+        Bitset result((Uninitialized()));
+        for (std::size_t w = 0; w < Words; ++w)
+            result.words[w] = a.words[w] & b.words[w];
+        return result;
+    }
+
+    friend Bitset operator|(const Bitset& a, const Bitset& b)
+    {
+        Bitset result((Uninitialized()));
+        for (std::size_t w = 0; w < Words; ++w)
+            result.words[w] = a.words[w] | b.words[w];
+        return result;
+    }
+
+    friend Bitset operator<<(Bitset a, const Bitset& bits) { return a <<= bits; }
+    friend Bitset operator>>(Bitset a, const Bitset& bits) { return a >>= bits; }
+    friend Bitset operator<<(Bitset a, unsigned long long bits) { return a <<= bits; }
+    friend Bitset operator>>(Bitset a, unsigned long long bits) { return a >>= bits; }
+
+    friend bool operator==(const Bitset& a, const Bitset& b)
+    {
+        std::uint64_t differ = 0;
+        for (std::size_t w = 0; w < Words; ++w)
+            differ |= a.words[w] ^ b.words[w];
+        return differ == 0;
+    }
+
+    friend bool operator!=(const Bitset& a, const Bitset& b)
+    {
+        return !(a == b);
+    }
+
+    // Most significant bit first, as std::bitset.
+    friend std::ostream& operator<<(std::ostream& out, const Bitset& bits)
+    {
+        for (std::size_t i = N; i-- > 0; )
+            out << (bits.test(i) ? '1' : '0');
+        return out;
+    }
+
+private:
+    struct Uninitialized {};
+
+    explicit Bitset(Uninitialized)
+    {}
+
+    bool highWords() const
+    {
+        std::uint64_t high = 0;
+        for (std::size_t w = 1; w < Words; ++w)
+            high |= words[w];
+        return high != 0;
+    }
+
+    void trim()
+    {
+        if (N % 64 != 0)
+            words[Words - 1] &= (std::uint64_t(1) << (N % 64)) - 1;
+    }
+
+    std::uint64_t words[Words];
+};
+}
+
+template <std::size_t N>
+using BitsetNumber = Number<aop::Bitset<N>>;
+
+#endif
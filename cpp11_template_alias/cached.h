@@ -0,0 +1,159 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef CACHED_H
+#define CACHED_H
+
+#include <utility>
+#include "aspects.h"
+
+/*
+* Caches a value derived from the number, such as a normalized form or a
+* hash, and computes it again only after a mutating operator has run.
+* DERIVE is a functor with a Result typedef, called with the FullType so
+* it may use any aspect of the stack: DERIVE()(number).
+*
+* It must be the outermost aspect. Aspects mutate copies of the number
+* through FullType (FullType tmp(*this); tmp += other), so they reach the
+* operators here, which invalidate and forward to the aspect below.
+*
+* The cache is stored next to the value, so the decorated type is no
+* longer layout compatible with its underlying type, and facilities
+* built on aop::underlying() reject it. derived() fills the cache of a
+* const object, so concurrent readers must synchronize.
+*/
+template <class DERIVE>
+struct CachedDerivedAspect
+{
+    template <class A>
+    class Type : public A
+    {
+    public:
+        typedef typename A::FullType FullType;
+        typedef typename DERIVE::Result Result;
+
+#ifdef INHERITING_CTORS
+        using A::A;
+#else
+        Type(typename A::UnderlyingType n)
+            : A(n), cache(), valid(false)
+        {}
+
+        Type(const A& a)
+            : A(a), cache(), valid(false)
+        {}
+#endif
+
+        const Result& derived() const
+        {
+            static_assert(std::is_same<FullType, Type>::value, "CachedDerivedAspect must be the outermost aspect");
+            if (!valid)
+            {
+                cache = DERIVE()(*static_cast<const FullType*>(this));
+                valid = true;
+            }
+            return cache;
+        }
+
+        template <class T, class B = A>
+        auto operator+=(const T& other) -> decltype(std::declval<B&>() += other)
+        {
+            valid = false;
+            return B::operator+=(other);
+        }
+
+        template <class T, class B = A>
+        auto operator-=(const T& other) -> decltype(std::declval<B&>() -= other)
+        {
+            valid = false;
+            return B::operator-=(other);
+        }
+
+        template <class T, class B = A>
+        auto operator&=(const T& other) -> decltype(std::declval<B&>() &= other)
+        {
+            valid = false;
+            return B::operator&=(other);
+        }
+
+        template <class T, class B = A>
+        auto operator|=(const T& other) -> decltype(std::declval<B&>() |= other)
+        {
+            valid = false;
+            return B::operator|=(other);
+        }
+
+        template <class T, class B = A>
+        auto operator>>=(const T& bitcount) -> decltype(std::declval<B&>() >>= bitcount)
+        {
+            valid = false;
+            return B::operator>>=(bitcount);
+        }
+
+        template <class B = A>
+        auto operator++() -> decltype(++std::declval<B&>())
+        {
+            valid = false;
+            return B::operator++();
+        }
+
+        template <class B = A>
+        auto operator++(int) -> decltype(std::declval<B&>()++)
+        {
+            valid = false;
+            return B::operator++(0);
+        }
+
+        template <class B = A>
+        auto operator--() -> decltype(--std::declval<B&>())
+        {
+            valid = false;
+            return B::operator--();
+        }
+
+        template <class B = A>
+        auto operator--(int) -> decltype(std::declval<B&>()--)
+        {
+            valid = false;
+            return B::operator--(0);
+        }
+
+    private:
+#ifdef INHERITING_CTORS
+        mutable Result cache = Result();
+        mutable bool valid = false;
+#else
+        mutable Result cache;
+        mutable bool valid;
+#endif
+    };
+};
+
+#endif
@@ -0,0 +1,345 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef COMPRESSED_H
+#define COMPRESSED_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#include "aop.h"
+
+namespace aop
+{
+
+/*
+* Read-only compressed column of 32 bit decorated integers. Values are
+* split in blocks of BlockSize and every block keeps whichever encoding
+* is smallest for it: frame of reference bit packing, zigzag delta bit
+* packing or stream VByte.
+*/
+template <class N>
+class CompressedArray
+{
+    typedef typename N::UnderlyingType T;
+    static_assert(std::is_integral<T>::value && sizeof(T) == 4, "CompressedArray stores 32 bit integers");
+    static_assert(std::is_standard_layout<N>::value && sizeof(N) == sizeof(T),
+                  "decorated type is not layout compatible with its underlying type");
+
+public:
+    enum Encoding { FrameOfReference, Delta, StreamVByte };
+
+    static const std::size_t BlockSize = 128;
+
+    CompressedArray(const N* values, std::size_t count)
+        : count(count)
+    {
+        for (std::size_t start = 0; start < count; start += BlockSize)
+            encodeBlock(values + start, count - start < BlockSize ? count - start : BlockSize);
+        data.resize(data.size() + Padding);
+    }
+
+    std::size_t size() const
+    {
+        return count;
+    }
+
+    std::size_t blocks() const
+    {
+        return infos.size();
+    }
+
+    // Compressed footprint, block descriptors included.
+    std::size_t bytes() const
+    {
+        return data.size() + infos.size() * sizeof(BlockInfo);
+    }
+
+    Encoding encoding(std::size_t block) const
+    {
+        return Encoding(infos[block].encoding);
+    }
+
+    // Decodes one block into out, which must hold BlockSize values.
+    std::size_t decodeBlock(std::size_t block, std::uint32_t* out) const
+    {
+        const BlockInfo& info = infos[block];
+        const std::uint8_t* in = &data[info.offset];
+        switch (info.encoding)
+        {
+        case FrameOfReference:
+            unpack(in, info.count, info.bits, out);
+            for (std::size_t i = 0; i < info.count; ++i)
+                out[i] += info.base;
+            break;
+        case Delta:
+        {
+            unpack(in, info.count, info.bits, out);
+            std::uint32_t previous = info.base;
+            for (std::size_t i = 0; i < info.count; ++i)
+            {
+                previous += (out[i] >> 1) ^ (0u - (out[i] & 1));
+                out[i] = previous;
+            }
+            break;
+        }
+        case StreamVByte:
+            decodeVByte(in, info.count, out);
+            break;
+        }
+        return info.count;
+    }
+
+    /*
+    * Streaming loop: f(const N* block, std::size_t n) sees every block once,
+    * decoded into a small buffer that stays in L1.
+    */
+    template <class F>
+    void forEachBlock(F f) const
+    {
+        std::uint32_t buffer[BlockSize];
+        for (std::size_t block = 0; block < infos.size(); ++block)
+        {
+            const std::size_t n = decodeBlock(block, buffer);
+            f(reinterpret_cast<const N*>(buffer), n);
+        }
+    }
+
+private:
+    // Decoders read whole words past the end of a block.
+    static const std::size_t Padding = 16;
+
+    struct BlockInfo
+    {
+        std::uint32_t offset;
+        std::uint32_t base;
+        std::uint8_t encoding;
+        std::uint8_t bits;
+        std::uint16_t count;
+    };
+
+    static unsigned int bitWidth(std::uint32_t v)
+    {
+        return v == 0 ? 0 : 32 - __builtin_clz(v);
+    }
+
+    static unsigned int byteLength(std::uint32_t v)
+    {
+        return v < (1u << 8) ? 1 : v < (1u << 16) ? 2 : v < (1u << 24) ? 3 : 4;
+    }
+
+    void encodeBlock(const N* values, std::size_t n)
+    {
+        std::uint32_t v[BlockSize];
+        std::memcpy(v, values, n * sizeof(T));
+
+        const std::uint32_t min = *std::min_element(v, v + n);
+        std::uint32_t forMax = 0;
+        std::uint32_t zigzag[BlockSize];
+        std::uint32_t deltaMax = 0;
+        std::size_t vbyteBytes = (n + 3) / 4 + (4 - n % 4) % 4;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            forMax = std::max(forMax, v[i] - min);
+            const std::int32_t delta = std::int32_t(v[i] - (i == 0 ? v[0] : v[i - 1]));
+            zigzag[i] = (std::uint32_t(delta) << 1) ^ std::uint32_t(delta >> 31);
+            deltaMax = std::max(deltaMax, zigzag[i]);
+            vbyteBytes += byteLength(v[i]);
+        }
+
+        BlockInfo info;
+        info.offset = data.size();
+        info.count = n;
+        const std::size_t forBytes = (n * bitWidth(forMax) + 7) / 8;
+        const std::size_t deltaBytes = (n * bitWidth(deltaMax) + 7) / 8;
+        if (forBytes <= deltaBytes && forBytes <= vbyteBytes)
+        {
+            info.encoding = FrameOfReference;
+            info.base = min;
+            info.bits = bitWidth(forMax);
+            for (std::size_t i = 0; i < n; ++i)
+                v[i] -= min;
+            pack(v, n, info.bits);
+        }
+        else if (deltaBytes <= vbyteBytes)
+        {
+            info.encoding = Delta;
+            info.base = v[0];
+            info.bits = bitWidth(deltaMax);
+            pack(zigzag, n, info.bits);
+        }
+        else
+        {
+            info.encoding = StreamVByte;
+            info.base = 0;
+            info.bits = 0;
+            encodeVByte(v, n);
+        }
+        infos.push_back(info);
+    }
+
+    void pack(const std::uint32_t* v, std::size_t n, unsigned int bits)
+    {
+        std::uint64_t buffer = 0;
+        unsigned int filled = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            buffer |= std::uint64_t(v[i]) << filled;
+            filled += bits;
+            while (filled >= 8)
+            {
+                data.push_back(std::uint8_t(buffer));
+                buffer >>= 8;
+                filled -= 8;
+            }
+        }
+        if (filled > 0)
+            data.push_back(std::uint8_t(buffer));
+    }
+
+    // The width is made a compile time constant so shifts and masks fold.
+    template <unsigned int BITS>
+    static void unpackFixed(const std::uint8_t* in, std::size_t n, std::uint32_t* out)
+    {
+        const std::uint64_t mask = (std::uint64_t(1) << BITS) - 1;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const std::size_t bit = i * BITS;
+            std::uint64_t word;
+            std::memcpy(&word, in + bit / 8, sizeof(word));
+            out[i] = std::uint32_t((word >> (bit % 8)) & mask);
+        }
+    }
+
+    template <unsigned int... BITS>
+    struct Unpackers
+    {
+        typedef void (*Unpacker)(const std::uint8_t*, std::size_t, std::uint32_t*);
+
+        static Unpacker get(unsigned int bits)
+        {
+            static const Unpacker table[] = { &unpackFixed<BITS>... };
+            return table[bits];
+        }
+    };
+
+    static void unpack(const std::uint8_t* in, std::size_t n, unsigned int bits, std::uint32_t* out)
+    {
+        typedef Unpackers<0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+                          17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32> All;
+        All::get(bits)(in, n, out);
+    }
+
+    // Groups of four values: one control byte with four 2 bit lengths,
+    // then the data bytes. The last group is padded with zeros.
+    void encodeVByte(const std::uint32_t* v, std::size_t n)
+    {
+        const std::size_t groups = (n + 3) / 4;
+        const std::size_t control = data.size();
+        data.resize(control + groups);
+        for (std::size_t i = 0; i < groups * 4; ++i)
+        {
+            const std::uint32_t value = i < n ? v[i] : 0;
+            const unsigned int length = byteLength(value);
+            data[control + i / 4] |= (length - 1) << (2 * (i % 4));
+            for (unsigned int b = 0; b < length; ++b)
+                data.push_back(std::uint8_t(value >> (8 * b)));
+        }
+    }
+
+    static void decodeVByte(const std::uint8_t* in, std::size_t n, std::uint32_t* out)
+    {
+        const std::size_t groups = (n + 3) / 4;
+        const std::uint8_t* control = in;
+        const std::uint8_t* p = in + groups;
+        const VByteTables& tables = VByteTables::instance();
+        for (std::size_t g = 0; g < groups; ++g)
+        {
+            const std::uint8_t c = control[g];
+#if defined(__SSSE3__)
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.shuffle[c]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * g), _mm_shuffle_epi8(bytes, shuffle));
+#else
+            const std::uint8_t* q = p;
+            for (unsigned int j = 0; j < 4; ++j)
+            {
+                const unsigned int length = ((c >> (2 * j)) & 3) + 1;
+                std::uint32_t value = 0;
+                for (unsigned int b = 0; b < length; ++b)
+                    value |= std::uint32_t(q[b]) << (8 * b);
+                out[4 * g + j] = value;
+                q += length;
+            }
+#endif
+            p += tables.length[c];
+        }
+    }
+
+    struct VByteTables
+    {
+        std::uint8_t shuffle[256][16];
+        std::uint8_t length[256];
+
+        VByteTables()
+        {
+            for (unsigned int c = 0; c < 256; ++c)
+            {
+                unsigned int offset = 0;
+                for (unsigned int j = 0; j < 4; ++j)
+                {
+                    const unsigned int bytes = ((c >> (2 * j)) & 3) + 1;
+                    for (unsigned int b = 0; b < 4; ++b)
+                        shuffle[c][4 * j + b] = b < bytes ? offset + b : 0x80;
+                    offset += bytes;
+                }
+                length[c] = offset;
+            }
+        }
+
+        static const VByteTables& instance()
+        {
+            static const VByteTables tables;
+            return tables;
+        }
+    };
+
+    std::size_t count;
+    std::vector<std::uint8_t> data;
+    std::vector<BlockInfo> infos;
+};
+}
+
+#endif
@@ -0,0 +1,149 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef DYNAMIC_H
+#define DYNAMIC_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "aop.h"
+
+namespace aop
+{
+
+/*
+* Picks one of a fixed set of aspect combinations at runtime, e.g. from
+* configuration:
+*
+*   typedef DynamicDecorate<Number<float>::Type>::among<
+*       Aspects<RoundAspect<2>::Type, ArithmeticAspect>,
+*       Aspects<ArithmeticAspect> > Semantics;
+*   Semantics semantics(config.rounding ? 0 : 1);
+*   semantics.apply(values, n, sumBatch);
+*
+* Every combination is instantiated up front and the choice is made once
+* per call through a table of function pointers, so the functor's loop
+* runs on the static decorated type with everything inlined. Buffers hold
+* UnderlyingType values and are viewed as the chosen decorated type.
+*/
+template <template <template <class> class> class Base>
+struct DynamicDecorate
+{
+    template <class T>
+    struct Tag
+    {
+        typedef T Type;
+    };
+
+    template <class ... Combinations>
+    class among
+    {
+    public:
+        typedef typename std::tuple_element<0, std::tuple<typename Combinations::template Decorated<Base>...> >::type First;
+        typedef typename First::UnderlyingType UnderlyingType;
+        static const std::size_t Count = sizeof...(Combinations);
+
+        explicit among(std::size_t index)
+            : selected(index)
+        {
+            if (index >= Count)
+                throw std::out_of_range("aop::DynamicDecorate: no such combination");
+        }
+
+        std::size_t index() const
+        {
+            return selected;
+        }
+
+        // Calls f(Tag<T>()) with T the selected decorated type.
+        template <class F>
+        auto visit(F&& f) const -> decltype(f(Tag<First>()))
+        {
+            typedef decltype(f(Tag<First>())) R;
+            static R (*const table[])(F&) = { &invokeTag<typename Combinations::template Decorated<Base>, F, R>... };
+            return table[selected](f);
+        }
+
+        // Calls f(values, n) with values viewed as the selected decorated type.
+        template <class F>
+        auto apply(UnderlyingType* values, std::size_t n, F&& f) const -> decltype(f(static_cast<First*>(0), n))
+        {
+            typedef decltype(f(static_cast<First*>(0), n)) R;
+            static R (*const table[])(UnderlyingType*, std::size_t, F&) = { &invokeBatch<typename Combinations::template Decorated<Base>, F, R>... };
+            return table[selected](values, n, f);
+        }
+
+        template <class F>
+        auto apply(const UnderlyingType* values, std::size_t n, F&& f) const -> decltype(f(static_cast<const First*>(0), n))
+        {
+            typedef decltype(f(static_cast<const First*>(0), n)) R;
+            static R (*const table[])(const UnderlyingType*, std::size_t, F&) = { &invokeConstBatch<typename Combinations::template Decorated<Base>, F, R>... };
+            return table[selected](values, n, f);
+        }
+
+    private:
+        template <class T, class F, class R>
+        static R invokeTag(F& f)
+        {
+            return f(Tag<T>());
+        }
+
+        template <class T, class F, class R>
+        static R invokeBatch(UnderlyingType* values, std::size_t n, F& f)
+        {
+            return f(&viewAs<T>(*values), n);
+        }
+
+        template <class T, class F, class R>
+        static R invokeConstBatch(const UnderlyingType* values, std::size_t n, F& f)
+        {
+            return f(static_cast<const T*>(&viewAs<T>(*const_cast<UnderlyingType*>(values))), n);
+        }
+
+        template <class T>
+        static T& viewAs(UnderlyingType& value)
+        {
+            static_assert(std::is_same<typename T::UnderlyingType, UnderlyingType>::value,
+                          "combinations must share the underlying type");
+            static_assert(std::is_standard_layout<T>::value && sizeof(T) == sizeof(UnderlyingType),
+                          "decorated type is not layout compatible with its underlying type");
+            return *reinterpret_cast<T*>(&value);
+        }
+
+        std::size_t selected;
+    };
+};
+
+}
+
+#endif
@@ -0,0 +1,210 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace aop
+{
+
+/*
+* One bit per value, 64 values per word. Bits past size() are always 0.
+*/
+class Bitmask
+{
+public:
+    explicit Bitmask(std::size_t size = 0)
+        : bits(size), words((size + 63) / 64)
+    {}
+
+    std::size_t size() const
+    {
+        return bits;
+    }
+
+    std::size_t count() const
+    {
+        std::size_t n = 0;
+        for (std::size_t w = 0; w < words.size(); ++w)
+            n += __builtin_popcountll(words[w]);
+        return n;
+    }
+
+    bool test(std::size_t i) const
+    {
+        return (words[i / 64] >> (i % 64)) & 1;
+    }
+
+    std::size_t wordCount() const
+    {
+        return words.size();
+    }
+
+    std::uint64_t word(std::size_t w) const
+    {
+        return words[w];
+    }
+
+    std::uint64_t& word(std::size_t w)
+    {
+        return words[w];
+    }
+
+    Bitmask& operator&=(const Bitmask& other)
+    {
+        for (std::size_t w = 0; w < words.size(); ++w)
+            words[w] &= other.words[w];
+        return *this;
+    }
+
+    Bitmask& operator|=(const Bitmask& other)
+    {
+        for (std::size_t w = 0; w < words.size(); ++w)
+            words[w] |= other.words[w];
+        return *this;
+    }
+
+    Bitmask operator~() const
+    {
+        Bitmask result(bits);
+        for (std::size_t w = 0; w < words.size(); ++w)
+            result.words[w] = ~words[w];
+        if (bits % 64 != 0)
+            result.words.back() &= (std::uint64_t(1) << (bits % 64)) - 1;
+        return result;
+    }
+
+    friend Bitmask operator&(Bitmask a, const Bitmask& b) { return a &= b; }
+    friend Bitmask operator|(Bitmask a, const Bitmask& b) { return a |= b; }
+
+private:
+    std::size_t bits;
+    std::vector<std::uint64_t> words;
+};
+
+typedef std::vector<std::uint32_t> SelectionVector;
+
+/*
+* Evaluates predicate over every value without branching on its result.
+*/
+template <class N, class Predicate>
+Bitmask evaluate(const N* values, std::size_t count, Predicate predicate)
+{
+    Bitmask mask(count);
+    for (std::size_t w = 0; w < mask.wordCount(); ++w)
+    {
+        const std::size_t base = w * 64;
+        const std::size_t n = count - base < 64 ? count - base : 64;
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            bits |= std::uint64_t(bool(predicate(values[base + i]))) << i;
+        mask.word(w) = bits;
+    }
+    return mask;
+}
+
+template <class N, class Predicate>
+Bitmask evaluate(const N* a, const N* b, std::size_t count, Predicate predicate)
+{
+    Bitmask mask(count);
+    for (std::size_t w = 0; w < mask.wordCount(); ++w)
+    {
+        const std::size_t base = w * 64;
+        const std::size_t n = count - base < 64 ? count - base : 64;
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            bits |= std::uint64_t(bool(predicate(a[base + i], b[base + i]))) << i;
+        mask.word(w) = bits;
+    }
+    return mask;
+}
+
+/*
+* Batch forms of LogicalAspect: the operators of the element type decide.
+*/
+template <class N>
+Bitmask truthMask(const N* values, std::size_t count)
+{
+    return evaluate(values, count, [](const N& n) { return !!n; });
+}
+
+template <class N>
+Bitmask logicalAnd(const N* a, const N* b, std::size_t count)
+{
+    return evaluate(a, b, count, [](const N& x, const N& y) { return x && y; });
+}
+
+template <class N>
+Bitmask logicalOr(const N* a, const N* b, std::size_t count)
+{
+    return evaluate(a, b, count, [](const N& x, const N& y) { return x || y; });
+}
+
+inline SelectionVector select(const Bitmask& mask)
+{
+    SelectionVector selection;
+    selection.reserve(mask.count());
+    for (std::size_t w = 0; w < mask.wordCount(); ++w)
+        for (std::uint64_t bits = mask.word(w); bits != 0; bits &= bits - 1)
+            selection.push_back(std::uint32_t(w * 64 + __builtin_ctzll(bits)));
+    return selection;
+}
+
+// out must hold selection.size() values.
+template <class N>
+std::size_t gather(const N* values, const SelectionVector& selection, N* out)
+{
+    for (std::size_t i = 0; i < selection.size(); ++i)
+        out[i] = values[selection[i]];
+    return selection.size();
+}
+
+/*
+* Moves the selected values to the front of out, keeping their order.
+* Every value is stored and the cursor advanced by its bit, so out must
+* hold mask.size() values. Returns how many were selected.
+*/
+template <class N>
+std::size_t compact(const N* values, const Bitmask& mask, N* out)
+{
+    std::size_t selected = 0;
+    for (std::size_t i = 0; i < mask.size(); ++i)
+    {
+        out[selected] = values[i];
+        selected += mask.test(i);
+    }
+    return selected;
+}
+}
+
+#endif
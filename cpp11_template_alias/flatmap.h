@@ -0,0 +1,360 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef FLATMAP_H
+#define FLATMAP_H
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace aop
+{
+
+/*
+* Hash functor for keys decorated with HashAspect, usable with the
+* standard containers as well.
+*/
+template <class N>
+struct Hash
+{
+    std::size_t operator()(const N& n) const
+    {
+        return n.hash();
+    }
+};
+
+/*
+* Open addressing map with one control byte per slot, probed 16 slots
+* at a time. The control byte of a full slot holds 7 bits of the hash,
+* so a single SIMD compare finds the candidates in a whole group.
+* Keys need hash() (HashAspect) and == (ComparisonAspect).
+*/
+template <class K, class V>
+class FlatMap
+{
+public:
+    typedef std::pair<const K, V> value_type;
+
+    static const std::size_t GroupSize = 16;
+
+    FlatMap()
+        : storage(NULL), control(NULL), slots(NULL), capacity(0), count(0), deleted(0)
+    {}
+
+    FlatMap(FlatMap&& other)
+        : storage(other.storage), control(other.control), slots(other.slots), capacity(other.capacity),
+          count(other.count), deleted(other.deleted)
+    {
+        other.storage = NULL;
+        other.control = NULL;
+        other.slots = NULL;
+        other.capacity = other.count = other.deleted = 0;
+    }
+
+    ~FlatMap()
+    {
+        clear();
+        release();
+    }
+
+    std::size_t size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    V* find(const K& key)
+    {
+        const std::size_t slot = lookup(key);
+        return slot == NotFound ? NULL : &slots[slot].second;
+    }
+
+    const V* find(const K& key) const
+    {
+        const std::size_t slot = lookup(key);
+        return slot == NotFound ? NULL : &slots[slot].second;
+    }
+
+    bool contains(const K& key) const
+    {
+        return lookup(key) != NotFound;
+    }
+
+    // Inserts (key, value) unless key is present; returns the mapped
+    // value and whether it was inserted.
+    std::pair<V*, bool> insert(const K& key, const V& value)
+    {
+        const std::size_t slot = lookup(key);
+        if (slot != NotFound)
+            return std::make_pair(&slots[slot].second, false);
+
+        if ((count + deleted + 1) * 8 > capacity * 7)
+            rehash(count * 2 + 2 > capacity * 7 / 8 ? capacity * 2 : capacity);
+
+        const std::size_t hash = key.hash();
+        const std::size_t free = findFree(hash);
+        deleted -= control[free] == Deleted;
+        control[free] = tag(hash);
+        new (&slots[free]) value_type(key, value);
+        ++count;
+        return std::make_pair(&slots[free].second, true);
+    }
+
+    V& operator[](const K& key)
+    {
+        V* value = find(key);
+        return value != NULL ? *value : *insert(key, V()).first;
+    }
+
+    bool erase(const K& key)
+    {
+        const std::size_t slot = lookup(key);
+        if (slot == NotFound)
+            return false;
+        slots[slot].~value_type();
+        control[slot] = Deleted;
+        --count;
+        ++deleted;
+        return true;
+    }
+
+    void clear()
+    {
+        for (std::size_t i = 0; i < capacity; ++i)
+            if (isFull(control[i]))
+                slots[i].~value_type();
+        if (capacity != 0)
+            std::memset(control, Empty, capacity);
+        count = deleted = 0;
+    }
+
+    template <class F>
+    void forEach(F f) const
+    {
+        for (std::size_t i = 0; i < capacity; ++i)
+            if (isFull(control[i]))
+                f(slots[i].first, slots[i].second);
+    }
+
+    void reserve(std::size_t n)
+    {
+        std::size_t wanted = GroupSize;
+        while (wanted * 7 / 8 < n)
+            wanted *= 2;
+        if (wanted > capacity)
+            rehash(wanted);
+    }
+
+private:
+    static const std::size_t NotFound = std::size_t(-1);
+    static const std::uint8_t Empty = 0x80;
+    static const std::uint8_t Deleted = 0xfe;
+
+    FlatMap(const FlatMap&);
+    FlatMap& operator=(const FlatMap&);
+
+    static bool isFull(std::uint8_t c)
+    {
+        return (c & 0x80) == 0;
+    }
+
+    // Low bits pick the group, the top 7 bits are kept as the tag.
+    static std::uint8_t tag(std::size_t hash)
+    {
+        return std::uint8_t(hash >> (8 * sizeof(std::size_t) - 7));
+    }
+
+    std::size_t groups() const
+    {
+        return capacity / GroupSize;
+    }
+
+    // Bit i set when control byte i of the group equals c.
+    static unsigned int match(const std::uint8_t* group, std::uint8_t c)
+    {
+#if defined(__SSE2__)
+        const __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(char(c))));
+#else
+        unsigned int bits = 0;
+        for (unsigned int i = 0; i < GroupSize; ++i)
+            bits |= unsigned(group[i] == c) << i;
+        return bits;
+#endif
+    }
+
+    // Bit i set when slot i of the group is empty or deleted.
+    static unsigned int matchFree(const std::uint8_t* group)
+    {
+#if defined(__SSE2__)
+        return _mm_movemask_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(group)));
+#else
+        unsigned int bits = 0;
+        for (unsigned int i = 0; i < GroupSize; ++i)
+            bits |= unsigned(group[i] >> 7) << i;
+        return bits;
+#endif
+    }
+
+    std::size_t lookup(const K& key) const
+    {
+        if (count == 0)
+            return NotFound;
+
+        const std::size_t hash = key.hash();
+        const std::uint8_t t = tag(hash);
+        const std::size_t mask = groups() - 1;
+        std::size_t g = hash & mask;
+        for (std::size_t step = 1; step <= groups(); ++step)
+        {
+            const std::uint8_t* group = control + g * GroupSize;
+            for (unsigned int bits = match(group, t); bits != 0; bits &= bits - 1)
+            {
+                const std::size_t slot = g * GroupSize + __builtin_ctz(bits);
+                if (slots[slot].first == key)
+                    return slot;
+            }
+            if (match(group, Empty) != 0)
+                return NotFound;
+            g = (g + step) & mask;
+        }
+        return NotFound;
+    }
+
+    std::size_t findFree(std::size_t hash) const
+    {
+        const std::size_t mask = groups() - 1;
+        std::size_t g = hash & mask;
+        for (std::size_t step = 1; ; ++step)
+        {
+            const unsigned int bits = matchFree(control + g * GroupSize);
+            if (bits != 0)
+                return g * GroupSize + __builtin_ctz(bits);
+            g = (g + step) & mask;
+        }
+    }
+
+    void rehash(std::size_t newCapacity)
+    {
+        if (newCapacity < GroupSize)
+            newCapacity = GroupSize;
+
+        void* oldStorage = storage;
+        std::uint8_t* oldControl = control;
+        value_type* oldSlots = slots;
+        const std::size_t oldCapacity = capacity;
+
+        // Control bytes are aligned to a group for the SIMD loads.
+        storage = ::operator new(newCapacity + GroupSize);
+        control = reinterpret_cast<std::uint8_t*>((reinterpret_cast<std::uintptr_t>(storage) + GroupSize - 1) & ~std::uintptr_t(GroupSize - 1));
+        std::memset(control, Empty, newCapacity);
+        slots = static_cast<value_type*>(::operator new(newCapacity * sizeof(value_type)));
+        capacity = newCapacity;
+        deleted = 0;
+
+        for (std::size_t i = 0; i < oldCapacity; ++i)
+            if (isFull(oldControl[i]))
+            {
+                const std::size_t hash = oldSlots[i].first.hash();
+                const std::size_t free = findFree(hash);
+                control[free] = tag(hash);
+                new (&slots[free]) value_type(std::move(oldSlots[i]));
+                oldSlots[i].~value_type();
+            }
+        ::operator delete(oldStorage);
+        ::operator delete(oldSlots);
+    }
+
+    void release()
+    {
+        ::operator delete(storage);
+        ::operator delete(slots);
+    }
+
+    void* storage;
+    std::uint8_t* control;
+    value_type* slots;
+    std::size_t capacity;
+    std::size_t count;
+    std::size_t deleted;
+};
+
+template <class K>
+class FlatSet
+{
+public:
+    std::size_t size() const
+    {
+        return map.size();
+    }
+
+    bool insert(const K& key)
+    {
+        return map.insert(key, None()).second;
+    }
+
+    bool contains(const K& key) const
+    {
+        return map.contains(key);
+    }
+
+    bool erase(const K& key)
+    {
+        return map.erase(key);
+    }
+
+    void reserve(std::size_t n)
+    {
+        map.reserve(n);
+    }
+
+    template <class F>
+    void forEach(F f) const
+    {
+        map.forEach([&f](const K& key, None) { f(key); });
+    }
+
+private:
+    struct None {};
+
+    FlatMap<K, None> map;
+};
+}
+
+#endif
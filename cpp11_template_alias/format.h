@@ -0,0 +1,177 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#include "aop.h"
+
+namespace aop
+{
+
+/*
+* Fixed number of decimals a decorated type wants when printed, taken from
+* a configurable aspect such as RoundAspect<PRECISION>; -1 when there is none.
+*/
+template <class N, class = void>
+struct FormatPrecision
+{
+    static const int value = -1;
+};
+
+template <class N>
+struct FormatPrecision<N, decltype(void(N::Precision))>
+{
+    static const int value = N::Precision;
+};
+
+template <class N>
+struct FormatWidth
+{
+    typedef typename N::UnderlyingType T;
+
+    // Upper bound on the characters toChars() writes for one value.
+    static const std::size_t value = std::is_floating_point<T>::value
+        ? (FormatPrecision<N>::value < 0 ? 32 : std::numeric_limits<T>::max_exponent10 + FormatPrecision<N>::value + 4)
+        : std::numeric_limits<T>::digits10 + 3;
+};
+
+/*
+* Values with a precision are truncated to it, not rounded, as RoundAspect
+* truncates: the shortest digits that read back as the value are cut
+* after the last decimal wanted, so 1.339 prints 1.33 with precision 2.
+*/
+template <class T, int Precision>
+std::to_chars_result toCharsTruncated(char* first, char* last, T n)
+{
+    if (!std::isfinite(n))
+        return std::to_chars(first, last, n);
+
+    char digits[std::numeric_limits<T>::max_exponent10 - std::numeric_limits<T>::min_exponent10
+                + std::numeric_limits<T>::max_digits10 + 4];
+    const char* end = std::to_chars(digits, digits + sizeof(digits), n, std::chars_format::fixed).ptr;
+    const char* point = std::find(static_cast<const char*>(digits), end, '.');
+    const std::size_t whole = point - digits;
+    const std::size_t decimals = point == end ? 0 : std::min<std::size_t>(end - point - 1, Precision);
+    const std::size_t length = whole + (Precision > 0 ? Precision + 1 : 0);
+    if (std::size_t(last - first) < length)
+        return std::to_chars_result{ last, std::errc::value_too_large };
+
+    char* out = std::copy(digits, digits + whole, first);
+    if (Precision > 0)
+    {
+        *out++ = '.';
+        out = std::copy(point + 1, point + 1 + decimals, out);
+        out = std::fill_n(out, Precision - decimals, '0');
+    }
+    return std::to_chars_result{ out, std::errc() };
+}
+
+template <class N>
+std::to_chars_result toChars(char* first, char* last, const N& value)
+{
+    typedef typename N::UnderlyingType T;
+    const T& n = underlying(value);
+    if constexpr (std::is_floating_point<T>::value && FormatPrecision<N>::value >= 0)
+        return toCharsTruncated<T, FormatPrecision<N>::value>(first, last, n);
+    else
+        return std::to_chars(first, last, n);
+}
+
+template <class N>
+std::from_chars_result fromChars(const char* first, const char* last, N& value)
+{
+    return std::from_chars(first, last, underlying(value));
+}
+
+/*
+* Formats as many values as fit in [first, last), each followed by the
+* delimiter. Advances first and returns how many values were written.
+*/
+template <class N>
+std::size_t formatDelimited(const N* values, std::size_t count, char*& first, char* last, char delimiter = '\n')
+{
+    std::size_t i = 0;
+    for (; i < count; ++i)
+    {
+        const std::to_chars_result result = toChars(first, last, values[i]);
+        if (result.ec != std::errc() || result.ptr == last)
+            break;
+        *result.ptr = delimiter;
+        first = result.ptr + 1;
+    }
+    return i;
+}
+
+template <class N>
+void formatDelimited(const N* values, std::size_t count, std::string& out, char delimiter = '\n')
+{
+    const std::size_t Block = 4096;
+    for (std::size_t done = 0; done < count; )
+    {
+        const std::size_t n = std::min(Block, count - done);
+        const std::size_t start = out.size();
+        out.resize(start + n * (FormatWidth<N>::value + 1));
+        char* first = &out[start];
+        done += formatDelimited(values + done, n, first, &out[0] + out.size(), delimiter);
+        out.resize(first - &out[0]);
+    }
+}
+
+/*
+* Parses delimiter separated values until last, appending them to out.
+* The last value may end at last instead of a delimiter. Returns where
+* parsing stopped: last on success, the offending character otherwise.
+*/
+template <class N>
+const char* parseDelimited(const char* first, const char* last, std::vector<N>& out, char delimiter = '\n')
+{
+    while (first != last)
+    {
+        typename N::UnderlyingType n;
+        const std::from_chars_result result = std::from_chars(first, last, n);
+        if (result.ec != std::errc() || (result.ptr != last && *result.ptr != delimiter))
+            return first;
+        out.push_back(N(n));
+        first = result.ptr == last ? last : result.ptr + 1;
+    }
+    return first;
+}
+}
+
+#endif
@@ -0,0 +1,216 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include "aspects.h"
+
+namespace aop
+{
+
+/*
+* One shared copy of every distinct value ever interned. Values are
+* spread over Shards by hash, each behind its own mutex, so threads
+* interning different values rarely wait for each other. Entries are
+* never removed: a reference returned by intern() stays valid until the
+* program ends.
+*/
+template <class T, class Hash = std::hash<T>>
+class InternTable
+{
+public:
+    static const std::size_t Shards = 16;
+
+    static InternTable& instance()
+    {
+        static InternTable table;
+        return table;
+    }
+
+    const T& intern(const T& value)
+    {
+        const std::size_t hash = Hash()(value);
+        Shard& shard = shards[hash % Shards];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto range = shard.index.equal_range(hash);
+        for (auto i = range.first; i != range.second; ++i)
+            if (*i->second == value)
+                return *i->second;
+        shard.values.push_back(value);
+        shard.index.emplace(hash, &shard.values.back());
+        return shard.values.back();
+    }
+
+    // Number of distinct values held.
+    std::size_t size()
+    {
+        std::size_t n = 0;
+        for (std::size_t s = 0; s < Shards; ++s)
+        {
+            std::lock_guard<std::mutex> lock(shards[s].mutex);
+            n += shards[s].values.size();
+        }
+        return n;
+    }
+
+private:
+    InternTable()
+    {}
+
+    struct Shard
+    {
+        std::mutex mutex;
+        // A deque never moves what it holds, so the index may point into it.
+        std::deque<T> values;
+        std::unordered_multimap<std::size_t, const T*> index;
+    };
+
+    Shard shards[Shards];
+};
+
+/*
+* Handle to an interned T: copying it copies a pointer, and since equal
+* values share one copy, == compares pointers. Every other operation
+* works on the values and interns its result, so interning pays off for
+* values that repeat, not for intermediate results that are all
+* different.
+*/
+template <class T, class Hash = std::hash<T>>
+class Interned
+{
+public:
+    typedef T Value;
+    typedef InternTable<T, Hash> Table;
+
+    Interned(const T& value)
+        : value(&Table::instance().intern(value))
+    {}
+
+    template <class U>
+    Interned(const U& value, typename std::enable_if<std::is_constructible<T, const U&>::value && !std::is_same<U, T>::value>::type* = 0)
+        : value(&Table::instance().intern(T(value)))
+    {}
+
+    const T& get() const
+    {
+        return *value;
+    }
+
+    explicit operator bool() const
+    {
+        return bool(*value);
+    }
+
+    bool operator!() const
+    {
+        return !*value;
+    }
+
+    Interned& operator+=(const Interned& other) { return *this = *value + *other.value; }
+    Interned& operator-=(const Interned& other) { return *this = *value - *other.value; }
+    Interned& operator&=(const Interned& other) { return *this = (*value & *other.value); }
+    Interned& operator|=(const Interned& other) { return *this = (*value | *other.value); }
+    Interned& operator<<=(const Interned& bits) { return *this = (*value << *bits.value); }
+    Interned& operator>>=(const Interned& bits) { return *this = (*value >> *bits.value); }
+
+    friend Interned operator+(Interned a, const Interned& b) { return a += b; }
+    friend Interned operator-(Interned a, const Interned& b) { return a -= b; }
+    friend Interned operator&(Interned a, const Interned& b) { return a &= b; }
+    friend Interned operator|(Interned a, const Interned& b) { return a |= b; }
+    friend Interned operator<<(Interned a, const Interned& bits) { return a <<= bits; }
+    friend Interned operator>>(Interned a, const Interned& bits) { return a >>= bits; }
+
+    friend bool operator==(const Interned& a, const Interned& b) { return a.value == b.value; }
+    friend bool operator!=(const Interned& a, const Interned& b) { return a.value != b.value; }
+    friend bool operator<(const Interned& a, const Interned& b) { return *a.value < *b.value; }
+    friend bool operator<=(const Interned& a, const Interned& b) { return !(*b.value < *a.value); }
+    friend bool operator>(const Interned& a, const Interned& b) { return *b.value < *a.value; }
+    friend bool operator>=(const Interned& a, const Interned& b) { return !(*a.value < *b.value); }
+
+    friend std::ostream& operator<<(std::ostream& out, const Interned& interned)
+    {
+        return out << *interned.value;
+    }
+
+private:
+    const T* value;
+};
+}
+
+/*
+* Interned values: a few large values repeated many times are stored once.
+* Put it on an InternNumber base, e.g.
+* Decorate<InternNumber<aop::BigInt>::Type>::with<InternAspect, ArithmeticAspect, ComparisonAspect>.
+*/
+template <class T>
+using InternNumber = Number<aop::Interned<T>>;
+
+template <class A>
+class InternAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+    typedef typename A::UnderlyingType UnderlyingType;
+    typedef typename UnderlyingType::Value Value;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    InternAspect(UnderlyingType n)
+        : A(n)
+    {}
+
+    InternAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    // The shared copy of the value.
+    const Value& value() const
+    {
+        return A::n.get();
+    }
+
+    // Number of distinct values of this type interned so far.
+    static std::size_t distinct()
+    {
+        return UnderlyingType::Table::instance().size();
+    }
+};
+
+#endif
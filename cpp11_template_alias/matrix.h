@@ -0,0 +1,421 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <cstddef>
+#include <iostream>
+#include "aspects.h"
+
+namespace aop
+{
+
+/*
+* Fixed size R x C matrix stored by rows; a vector is a single column.
+* A scalar stands for the matrix with every element equal to it, so
+* m + 1 adds 1 everywhere. Element-wise loops have a constant trip count
+* and compile to SIMD.
+*/
+template <class T, std::size_t R, std::size_t C>
+class Dense
+{
+public:
+    typedef T Element;
+    static const std::size_t Rows = R;
+    static const std::size_t Columns = C;
+    static const std::size_t Size = R * C;
+
+    Dense()
+        : values()
+    {}
+
+    Dense(T fill)
+    {
+        for (std::size_t i = 0; i < Size; ++i)
+            values[i] = fill;
+    }
+
+    T& operator()(std::size_t row, std::size_t column)
+    {
+        return values[row * C + column];
+    }
+
+    const T& operator()(std::size_t row, std::size_t column) const
+    {
+        return values[row * C + column];
+    }
+
+    T* data()
+    {
+        return values;
+    }
+
+    const T* data() const
+    {
+        return values;
+    }
+
+    Dense& operator+=(const Dense& other)
+    {
+        for (std::size_t i = 0; i < Size; ++i)
+            values[i] += other.values[i];
+        return *this;
+    }
+
+    Dense& operator-=(const Dense& other)
+    {
+        for (std::size_t i = 0; i < Size; ++i)
+            values[i] -= other.values[i];
+        return *this;
+    }
+
+    Dense& operator+=(T scalar)
+    {
+        for (std::size_t i = 0; i < Size; ++i)
+            values[i] += scalar;
+        return *this;
+    }
+
+    Dense& operator-=(T scalar)
+    {
+        for (std::size_t i = 0; i < Size; ++i)
+            values[i] -= scalar;
+        return *this;
+    }
+
+    friend Dense operator+(Dense a, const Dense& b) { return a += b; }
+    friend Dense operator-(Dense a, const Dense& b) { return a -= b; }
+
+    friend bool operator==(const Dense& a, const Dense& b)
+    {
+        bool equal = true;
+        for (std::size_t i = 0; i < Size; ++i)
+            equal &= a.values[i] == b.values[i];
+        return equal;
+    }
+
+    friend bool operator!=(const Dense& a, const Dense& b)
+    {
+        return !(a == b);
+    }
+
+    // Rows separated by ';': [1 2; 3 4].
+    friend std::ostream& operator<<(std::ostream& out, const Dense& m)
+    {
+        out << '[';
+        for (std::size_t r = 0; r < R; ++r)
+            for (std::size_t c = 0; c < C; ++c)
+                out << m(r, c) << (c + 1 < C ? " " : r + 1 < R ? "; " : "]");
+        return out;
+    }
+
+private:
+    T values[Size];
+};
+
+/*
+* Rows of a times b, MatrixBlockColumns columns at a time: the partial row
+* of the product is accumulated in a fixed size block the compiler keeps
+* in vector registers, while the rows of b it reads are contiguous.
+*/
+static const std::size_t MatrixBlockColumns = 32;
+
+template <std::size_t WIDTH>
+struct ProductBlock
+{
+    template <class T, std::size_t R, std::size_t K, std::size_t C>
+    static void multiply(const Dense<T, R, K>& a, const Dense<T, K, C>& b, Dense<T, R, C>& product, std::size_t i, std::size_t j0)
+    {
+        T row[WIDTH] = {};
+        for (std::size_t k = 0; k < K; ++k)
+        {
+            const T factor = a(i, k);
+            const T* along = &b(k, j0);
+            for (std::size_t j = 0; j < WIDTH; ++j)
+                row[j] += factor * along[j];
+        }
+        for (std::size_t j = 0; j < WIDTH; ++j)
+            product(i, j0 + j) = row[j];
+    }
+};
+
+template <>
+struct ProductBlock<0>
+{
+    template <class T, std::size_t R, std::size_t K, std::size_t C>
+    static void multiply(const Dense<T, R, K>&, const Dense<T, K, C>&, Dense<T, R, C>&, std::size_t, std::size_t)
+    {}
+};
+
+template <class T, std::size_t R, std::size_t K, std::size_t C>
+Dense<T, R, C> operator*(const Dense<T, R, K>& a, const Dense<T, K, C>& b)
+{
+    const std::size_t Block = C < MatrixBlockColumns ? C : MatrixBlockColumns;
+    const std::size_t Full = C - C % Block;
+    Dense<T, R, C> product;
+    for (std::size_t i = 0; i < R; ++i)
+    {
+        for (std::size_t j0 = 0; j0 < Full; j0 += Block)
+            ProductBlock<Block>::multiply(a, b, product, i, j0);
+        ProductBlock<C % Block>::multiply(a, b, product, i, Full);
+    }
+    return product;
+}
+
+// RoundAspect rounds every element.
+template <unsigned int PRECISION, class T, std::size_t R, std::size_t C>
+Dense<T, R, C> roundTo(const Dense<T, R, C>& m)
+{
+    Dense<T, R, C> rounded;
+    for (std::size_t r = 0; r < R; ++r)
+        for (std::size_t c = 0; c < C; ++c)
+            rounded(r, c) = ::roundTo<PRECISION>(m(r, c));
+    return rounded;
+}
+}
+
+template <class T, std::size_t R, std::size_t C>
+using Matrix = Number<aop::Dense<T, R, C>>;
+
+template <class T, std::size_t N>
+using Vector = Number<aop::Dense<T, N, 1>>;
+
+/*
+* Element-wise expression fusion: a + b - c + 1 builds an Expression, which
+* is evaluated in a single pass with no temporaries when assigned to a
+* FullType, m = a + b - c + 1. Constructing one from it copies the first
+* operand first. Like auto with Eigen, an Expression only refers to its
+* operands, so convert it before they go away. Operators of the aspects
+* below are bypassed; put ArithmeticAspect there for +=, -= and raw + m.
+*
+* Aspects above it must leave + and - alone, as PooledAspect does:
+* RoundAspect, for one, expects a FullType out of the + it wraps. Only as
+* the outermost aspect is assignment done in place; below another one,
+* m = a + b builds the FullType first and copies it.
+*/
+template <class A>
+class FusedAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+    typedef typename A::UnderlyingType UnderlyingType;
+    typedef typename UnderlyingType::Element Element;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    FusedAspect(UnderlyingType n)
+        : A(n)
+    {}
+
+    FusedAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    struct Plus
+    {
+        static Element apply(Element a, Element b) { return a + b; }
+    };
+
+    struct Minus
+    {
+        static Element apply(Element a, Element b) { return a - b; }
+    };
+
+    class Leaf
+    {
+    public:
+        explicit Leaf(const FullType& value)
+            : value(&value)
+        {}
+
+        Element operator[](std::size_t i) const
+        {
+            return aop::underlying(*value).data()[i];
+        }
+
+        const FullType& first() const
+        {
+            return *value;
+        }
+
+    private:
+        const FullType* value;
+    };
+
+    class Scalar
+    {
+    public:
+        explicit Scalar(Element value)
+            : value(value)
+        {}
+
+        Element operator[](std::size_t) const
+        {
+            return value;
+        }
+
+    private:
+        Element value;
+    };
+
+    template <class L, class R, class Op>
+    class Expression
+    {
+    public:
+        Expression(const L& left, const R& right)
+            : left(left), right(right)
+        {}
+
+        Element operator[](std::size_t i) const
+        {
+            return Op::apply(left[i], right[i]);
+        }
+
+        Expression<Expression, Leaf, Plus> operator+(const FullType& other) const
+        {
+            return Expression<Expression, Leaf, Plus>(*this, Leaf(other));
+        }
+
+        Expression<Expression, Leaf, Minus> operator-(const FullType& other) const
+        {
+            return Expression<Expression, Leaf, Minus>(*this, Leaf(other));
+        }
+
+        template <class L2, class R2, class Op2>
+        Expression<Expression, Expression<L2, R2, Op2>, Plus> operator+(const Expression<L2, R2, Op2>& other) const
+        {
+            return Expression<Expression, Expression<L2, R2, Op2>, Plus>(*this, other);
+        }
+
+        template <class L2, class R2, class Op2>
+        Expression<Expression, Expression<L2, R2, Op2>, Minus> operator-(const Expression<L2, R2, Op2>& other) const
+        {
+            return Expression<Expression, Expression<L2, R2, Op2>, Minus>(*this, other);
+        }
+
+        template <class T>
+        EnableIfRaw<T, Expression<Expression, Scalar, Plus>> operator+(T other) const
+        {
+            return Expression<Expression, Scalar, Plus>(*this, Scalar(other));
+        }
+
+        template <class T>
+        EnableIfRaw<T, Expression<Expression, Scalar, Minus>> operator-(T other) const
+        {
+            return Expression<Expression, Scalar, Minus>(*this, Scalar(other));
+        }
+
+        // The leftmost operand of an Expression is always a FullType.
+        const FullType& first() const
+        {
+            return left.first();
+        }
+
+        // Copying an operand is a plain memcpy, where building a FullType
+        // from a new value copies it once per aspect constructor. The copy
+        // is then overwritten in place, without going through operator=,
+        // which is only FusedAspect's when it is the outermost aspect.
+        operator FullType() const
+        {
+            FullType result(first());
+            Element* values = aop::underlying(result).data();
+#pragma GCC ivdep
+            for (std::size_t i = 0; i < UnderlyingType::Size; ++i)
+                values[i] = (*this)[i];
+            return result;
+        }
+
+        friend std::ostream& operator<<(std::ostream& out, const Expression& expression)
+        {
+            return out << FullType(expression);
+        }
+
+    private:
+        L left;
+        R right;
+    };
+
+    Expression<Leaf, Leaf, Plus> operator+(const FullType& other) const
+    {
+        return Expression<Leaf, Leaf, Plus>(self(), Leaf(other));
+    }
+
+    Expression<Leaf, Leaf, Minus> operator-(const FullType& other) const
+    {
+        return Expression<Leaf, Leaf, Minus>(self(), Leaf(other));
+    }
+
+    template <class L, class R, class Op>
+    Expression<Leaf, Expression<L, R, Op>, Plus> operator+(const Expression<L, R, Op>& other) const
+    {
+        return Expression<Leaf, Expression<L, R, Op>, Plus>(self(), other);
+    }
+
+    template <class L, class R, class Op>
+    Expression<Leaf, Expression<L, R, Op>, Minus> operator-(const Expression<L, R, Op>& other) const
+    {
+        return Expression<Leaf, Expression<L, R, Op>, Minus>(self(), other);
+    }
+
+    template <class T>
+    EnableIfRaw<T, Expression<Leaf, Scalar, Plus>> operator+(T other) const
+    {
+        return Expression<Leaf, Scalar, Plus>(self(), Scalar(other));
+    }
+
+    template <class T>
+    EnableIfRaw<T, Expression<Leaf, Scalar, Minus>> operator-(T other) const
+    {
+        return Expression<Leaf, Scalar, Minus>(self(), Scalar(other));
+    }
+
+    // Evaluates in place. Elements are read and written at the same index,
+    // so m = m + a is safe and the loop carries no dependency.
+    template <class L, class R, class Op>
+    FullType& operator=(const Expression<L, R, Op>& expression)
+    {
+        Element* values = aop::underlying(*static_cast<FullType*>(this)).data();
+#pragma GCC ivdep
+        for (std::size_t i = 0; i < UnderlyingType::Size; ++i)
+            values[i] = expression[i];
+        return *static_cast<FullType*>(this);
+    }
+
+private:
+    Leaf self() const
+    {
+        return Leaf(*static_cast<const FullType*>(this));
+    }
+};
+
+#endif
@@ -0,0 +1,235 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+namespace aop
+{
+
+/*
+* Results of a binary operation on T, cached in SLOTS entries grouped in
+* sets of WAYS. A key maps to one set; on a miss the least recently used
+* entry of the set is replaced, so WAYS = 1 is a plain direct mapped
+* table. Entries are small and contiguous, a lookup touches one set.
+* Tables are meant for static or thread storage, which starts them
+* zeroed, that is empty, without running any code.
+*/
+template <class T, std::size_t SLOTS, std::size_t WAYS = 1>
+class MemoTable
+{
+public:
+    static_assert(SLOTS > 0 && SLOTS % WAYS == 0, "SLOTS must be a multiple of WAYS");
+    static const std::size_t Sets = SLOTS / WAYS;
+
+    struct Stats
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+    };
+
+    // Returns the cached f() for (op, a, b), calling f on a miss.
+    template <class F>
+    T lookup(unsigned char op, const T& a, const T& b, F f)
+    {
+        Entry* set = &entries[key(op, a, b) % Sets * WAYS];
+        // Which way holds the key is unpredictable: select it without branching.
+        std::size_t hit = WAYS;
+        for (std::size_t i = 0; i < WAYS; ++i)
+            hit = (set[i].used != 0) & (set[i].op == op) & same(set[i].a, a) & same(set[i].b, b) ? i : hit;
+        if (hit != WAYS)
+        {
+            set[hit].used = tick();
+            ++stats.hits;
+            return set[hit].result;
+        }
+
+        Entry* victim = set;
+        for (std::size_t i = 1; i < WAYS; ++i)
+            if (set[i].used < victim->used)
+                victim = &set[i];
+        ++stats.misses;
+        const T result = f();
+        victim->op = op;
+        victim->a = a;
+        victim->b = b;
+        victim->result = result;
+        victim->used = tick();
+        return result;
+    }
+
+    const Stats& statistics() const
+    {
+        return stats;
+    }
+
+    void clear()
+    {
+        for (std::size_t i = 0; i < SLOTS; ++i)
+            entries[i].used = 0;
+        clock = 0;
+        stats.hits = stats.misses = 0;
+    }
+
+private:
+    struct Entry
+    {
+        T a;
+        T b;
+        T result;
+        std::uint32_t used;
+        unsigned char op;
+    };
+
+    // Stamps for the least recently used choice; 0 marks a free entry.
+    std::uint32_t tick()
+    {
+        if (++clock == 0)
+        {
+            for (std::size_t i = 0; i < SLOTS; ++i)
+                entries[i].used = entries[i].used != 0;
+            clock = 2;
+        }
+        return clock;
+    }
+
+    template <class U>
+    struct Flat : std::integral_constant<bool, std::is_trivially_copyable<U>::value && sizeof(U) <= 8>
+    {};
+
+    template <class U>
+    static typename std::enable_if<Flat<U>::value, std::uint64_t>::type bits(const U& x)
+    {
+        std::uint64_t b = 0;
+        std::memcpy(&b, &x, sizeof(U));
+        return b;
+    }
+
+    template <class U>
+    static typename std::enable_if<!Flat<U>::value, std::uint64_t>::type bits(const U& x)
+    {
+        return std::hash<U>()(x);
+    }
+
+    // Compares bit patterns when it can, so that a cached NaN is found again.
+    template <class U>
+    static typename std::enable_if<Flat<U>::value, bool>::type same(const U& x, const U& y)
+    {
+        return bits(x) == bits(y);
+    }
+
+    template <class U>
+    static typename std::enable_if<!Flat<U>::value, bool>::type same(const U& x, const U& y)
+    {
+        return x == y;
+    }
+
+    static std::size_t key(unsigned char op, const T& a, const T& b)
+    {
+        std::uint64_t h = (bits(a) * 0x9e3779b97f4a7c15ULL ^ bits(b)) + op;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return std::size_t(h);
+    }
+
+    Entry entries[SLOTS];
+    std::uint32_t clock;
+    Stats stats;
+};
+}
+
+/*
+* Caches the results of + and - of the aspects below it, which must be
+* pure functions of the operands. Put it in front of costly ones:
+* with<MemoizeAspect<4096, 2>::Type, RoundAspect<2>::Type, ArithmeticAspect>.
+* Every thread has its own table per decorated type, so lookups never
+* contend; statistics() and clear() act on the calling thread's table.
+*/
+template <std::size_t SLOTS, std::size_t WAYS = 1>
+struct MemoizeAspect
+{
+    template <class A>
+    class Type : public A
+    {
+    public:
+        typedef typename A::FullType FullType;
+        typedef aop::MemoTable<typename A::UnderlyingType, SLOTS, WAYS> Table;
+
+#ifdef INHERITING_CTORS
+        using A::A;
+#else
+        Type(typename A::UnderlyingType n)
+            : A(n)
+        {}
+
+        Type(const A& a)
+            : A(a)
+        {}
+#endif
+
+        FullType operator+(const FullType& other) const
+        {
+            return FullType(table().lookup(Plus, A::n, other.n, [&] { return A::operator+(other).n; }));
+        }
+
+        FullType operator-(const FullType& other) const
+        {
+            return FullType(table().lookup(Minus, A::n, other.n, [&] { return A::operator-(other).n; }));
+        }
+
+        static const typename Table::Stats& statistics()
+        {
+            return table().statistics();
+        }
+
+        static void clear()
+        {
+            table().clear();
+        }
+
+    private:
+        enum { Plus, Minus };
+
+        static Table& table()
+        {
+            thread_local Table memo;
+            return memo;
+        }
+    };
+};
+
+#endif
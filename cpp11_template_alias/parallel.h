@@ -0,0 +1,340 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aop
+{
+namespace parallel
+{
+
+/*
+* Work stealing pool: every thread owns a queue, takes work from its back
+* and steals from the front of the others when it runs dry. The thread
+* calling run() works as well, so a pool of n threads starts n - 1.
+*/
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency())
+        : queues(threads == 0 ? 1 : threads), pending(0), stop(false)
+    {
+        for (std::size_t i = 1; i < queues.size(); ++i)
+            workers.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (std::size_t i = 0; i < workers.size(); ++i)
+            workers[i].join();
+    }
+
+    std::size_t size() const
+    {
+        return queues.size();
+    }
+
+    // Calls task(i) for every i in [0, tasks) and waits for all of them.
+    // If tasks throw, the first exception is rethrown once all are done.
+    void run(std::size_t tasks, const std::function<void(std::size_t)>& task)
+    {
+        if (tasks == 0)
+            return;
+
+        Job job(task, tasks);
+        // Counted before publishing, or a thief could decrement it below zero.
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            pending += tasks;
+        }
+        for (std::size_t i = 0; i < tasks; ++i)
+        {
+            Queue& queue = queues[i % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.items.push_back(Item(&job, i));
+        }
+        wake.notify_all();
+
+        while (runOne(0))
+            ;
+        // Nothing left to take: wait for the tasks other threads are running.
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.done.wait(lock, [&job] { return job.remaining == 0; });
+        if (job.error)
+            std::rethrow_exception(job.error);
+    }
+
+    static ThreadPool& instance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    struct Job
+    {
+        Job(const std::function<void(std::size_t)>& task, std::size_t tasks)
+            : task(task), remaining(tasks)
+        {}
+
+        const std::function<void(std::size_t)>& task;
+        std::size_t remaining;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    typedef std::pair<Job*, std::size_t> Item;
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Item> items;
+    };
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    bool take(std::size_t self, Item& item)
+    {
+        for (std::size_t k = 0; k < queues.size(); ++k)
+        {
+            Queue& queue = queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.items.empty())
+                continue;
+            if (k == 0)
+            {
+                item = queue.items.back();
+                queue.items.pop_back();
+            }
+            else
+            {
+                item = queue.items.front();
+                queue.items.pop_front();
+            }
+            --pending;
+            return true;
+        }
+        return false;
+    }
+
+    bool runOne(std::size_t self)
+    {
+        Item item;
+        if (!take(self, item))
+            return false;
+
+        Job& job = *item.first;
+        std::exception_ptr error;
+        try
+        {
+            job.task(item.second);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        // Under the lock so run() cannot return, and destroy the job,
+        // before the last task is done touching it.
+        std::lock_guard<std::mutex> lock(job.mutex);
+        if (error && !job.error)
+            job.error = error;
+        if (--job.remaining == 0)
+            job.done.notify_all();
+        return true;
+    }
+
+    void work(std::size_t self)
+    {
+        for (;;)
+        {
+            if (runOne(self))
+                continue;
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [this] { return stop || pending.load() != 0; });
+            if (stop && pending.load() == 0)
+                return;
+        }
+    }
+
+    std::vector<Queue> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> pending;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stop;
+};
+
+/*
+* Chunks depend only on the input size, never on the number of threads,
+* and partial results are combined left to right: reductions give the
+* same result, bit for bit, on any pool.
+*/
+const std::size_t ChunkSize = 1 << 14;
+
+inline std::size_t chunks(std::size_t n)
+{
+    return (n + ChunkSize - 1) / ChunkSize;
+}
+
+struct Plus
+{
+    template <class N>
+    N operator()(const N& a, const N& b) const
+    {
+        return a + b;
+    }
+};
+
+struct BitwiseOr
+{
+    template <class N>
+    N operator()(const N& a, const N& b) const
+    {
+        return a | b;
+    }
+};
+
+struct BitwiseAnd
+{
+    template <class N>
+    N operator()(const N& a, const N& b) const
+    {
+        return a & b;
+    }
+};
+
+template <class N, class F>
+void for_each(ThreadPool& pool, N* first, N* last, F f)
+{
+    const std::size_t n = last - first;
+    pool.run(chunks(n), [=](std::size_t c) {
+        const std::size_t end = std::min(n, (c + 1) * ChunkSize);
+        for (std::size_t i = c * ChunkSize; i < end; ++i)
+            f(first[i]);
+    });
+}
+
+// out must point to n existing values.
+template <class N, class M, class F>
+void transform(ThreadPool& pool, const N* first, const N* last, M* out, F f)
+{
+    const std::size_t n = last - first;
+    pool.run(chunks(n), [=](std::size_t c) {
+        const std::size_t end = std::min(n, (c + 1) * ChunkSize);
+        for (std::size_t i = c * ChunkSize; i < end; ++i)
+            out[i] = f(first[i]);
+    });
+}
+
+template <class N, class M, class Reduce, class Transform>
+M transform_reduce(ThreadPool& pool, const N* first, const N* last, M init, Reduce reduce, Transform transform)
+{
+    const std::size_t n = last - first;
+    std::vector<M> partials(chunks(n), init);
+    M* partial = partials.empty() ? NULL : &partials[0];
+    pool.run(partials.size(), [=](std::size_t c) {
+        const std::size_t end = std::min(n, (c + 1) * ChunkSize);
+        M accumulator = transform(first[c * ChunkSize]);
+        for (std::size_t i = c * ChunkSize + 1; i < end; ++i)
+            accumulator = reduce(accumulator, transform(first[i]));
+        partial[c] = accumulator;
+    });
+
+    for (std::size_t c = 0; c < partials.size(); ++c)
+        init = reduce(init, partials[c]);
+    return init;
+}
+
+template <class N, class Reduce>
+N reduce(ThreadPool& pool, const N* first, const N* last, N init, Reduce op)
+{
+    return transform_reduce(pool, first, last, init, op, [](const N& n) { return n; });
+}
+
+template <class N>
+N reduce(ThreadPool& pool, const N* first, const N* last, N init)
+{
+    return reduce(pool, first, last, init, Plus());
+}
+
+// The same algorithms on the shared pool.
+template <class N, class F>
+void for_each(N* first, N* last, F f)
+{
+    for_each(ThreadPool::instance(), first, last, f);
+}
+
+template <class N, class M, class F>
+void transform(const N* first, const N* last, M* out, F f)
+{
+    transform(ThreadPool::instance(), first, last, out, f);
+}
+
+template <class N, class M, class Reduce, class Transform>
+M transform_reduce(const N* first, const N* last, M init, Reduce reduce, Transform transform)
+{
+    return transform_reduce(ThreadPool::instance(), first, last, init, reduce, transform);
+}
+
+template <class N, class Reduce>
+N reduce(const N* first, const N* last, N init, Reduce op)
+{
+    return reduce(ThreadPool::instance(), first, last, init, op);
+}
+
+template <class N>
+N reduce(const N* first, const N* last, N init)
+{
+    return reduce(ThreadPool::instance(), first, last, init);
+}
+}
+}
+
+#endif
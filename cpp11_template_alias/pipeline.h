@@ -0,0 +1,447 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <istream>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aop
+{
+namespace pipeline
+{
+
+/*
+* Bounded single producer, single consumer ring. The capacity is rounded
+* up to a power of two; head and tail sit on their own cache lines and
+* each side caches the other's index to touch it only when needed.
+*/
+template <class T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(std::size_t capacity)
+        : items(roundUp(capacity)), mask(items.size() - 1), head(0), tail(0), cachedHead(0), cachedTail(0)
+    {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    bool tryPush(T& item)
+    {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == items.size())
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == items.size())
+                return false;
+        }
+        items[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& item)
+    {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail)
+                return false;
+        }
+        item = std::move(items[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const
+    {
+        return items.size();
+    }
+
+private:
+    static std::size_t roundUp(std::size_t n)
+    {
+        std::size_t size = 1;
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+
+    std::vector<T> items;
+    const std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head;
+    alignas(64) std::atomic<std::size_t> tail;
+    // Written only by the producer (cachedHead) or the consumer (cachedTail).
+    alignas(64) std::size_t cachedHead;
+    alignas(64) std::size_t cachedTail;
+};
+
+template <class N>
+using Batch = std::vector<N>;
+
+/*
+* A stage suspended on a full or empty channel records how to retry the
+* operation; the scheduler only resumes it once the retry succeeds.
+*/
+struct Blocked
+{
+    bool (*retry)(void*);
+    void* awaiter;
+};
+
+class Stage
+{
+public:
+    struct promise_type
+    {
+        Stage get_return_object() { return Stage(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+
+        Blocked blocked = { nullptr, nullptr };
+        std::exception_ptr error;
+    };
+
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Stage(Stage&& other)
+        : handle(std::exchange(other.handle, nullptr))
+    {}
+
+    Stage& operator=(Stage&& other)
+    {
+        std::swap(handle, other.handle);
+        return *this;
+    }
+
+    ~Stage()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    bool done() const
+    {
+        return handle.done();
+    }
+
+    // Resumes the stage if it can make progress; returns whether it did.
+    bool step()
+    {
+        Blocked& blocked = handle.promise().blocked;
+        if (blocked.retry != nullptr)
+        {
+            if (!blocked.retry(blocked.awaiter))
+                return false;
+            blocked.retry = nullptr;
+        }
+        handle.resume();
+        return true;
+    }
+
+    std::exception_ptr error() const
+    {
+        return handle.promise().error;
+    }
+
+private:
+    explicit Stage(Handle handle)
+        : handle(handle)
+    {}
+
+    Handle handle;
+};
+
+/*
+* Batches of N flowing from one stage to the next. push() suspends the
+* producer while the channel is full, which is the backpressure; pop()
+* suspends the consumer while it is empty and yields nothing once the
+* producer has closed the channel and it has been drained.
+*/
+template <class N>
+class Channel
+{
+public:
+    explicit Channel(std::size_t batchSize = 1024, std::size_t batches = 8)
+        : queue(batches), size(batchSize), closed(false)
+    {}
+
+    std::size_t batchSize() const
+    {
+        return size;
+    }
+
+    void close()
+    {
+        closed.store(true, std::memory_order_release);
+    }
+
+    class PushAwaiter
+    {
+    public:
+        PushAwaiter(Channel& channel, Batch<N>&& batch)
+            : channel(channel), batch(std::move(batch))
+        {}
+
+        bool await_ready() { return channel.queue.tryPush(batch); }
+        void await_suspend(Stage::Handle handle) { handle.promise().blocked = { &retry, this }; }
+        void await_resume() {}
+
+    private:
+        static bool retry(void* self)
+        {
+            return static_cast<PushAwaiter*>(self)->await_ready();
+        }
+
+        Channel& channel;
+        Batch<N> batch;
+    };
+
+    class PopAwaiter
+    {
+    public:
+        explicit PopAwaiter(Channel& channel)
+            : channel(channel)
+        {}
+
+        bool await_ready()
+        {
+            // Read closed first: a close seen here happened after every push.
+            const bool finished = channel.closed.load(std::memory_order_acquire);
+            Batch<N> next;
+            if (channel.queue.tryPop(next))
+                batch = std::move(next);
+            else if (!finished)
+                return false;
+            return true;
+        }
+
+        void await_suspend(Stage::Handle handle) { handle.promise().blocked = { &retry, this }; }
+        std::optional<Batch<N>> await_resume() { return std::move(batch); }
+
+    private:
+        static bool retry(void* self)
+        {
+            return static_cast<PopAwaiter*>(self)->await_ready();
+        }
+
+        Channel& channel;
+        std::optional<Batch<N>> batch;
+    };
+
+    PushAwaiter push(Batch<N>&& batch)
+    {
+        return PushAwaiter(*this, std::move(batch));
+    }
+
+    PopAwaiter pop()
+    {
+        return PopAwaiter(*this);
+    }
+
+private:
+    SpscQueue<Batch<N>> queue;
+    const std::size_t size;
+    std::atomic<bool> closed;
+};
+
+/*
+* Runs stages on a number of threads: stages are spread round robin (or
+* placed explicitly) and each thread steps its own in turn, so stages
+* sharing a thread interleave at every blocked push or pop. The calling
+* thread runs the first group. Channels must outlive run().
+*/
+class Pipeline
+{
+public:
+    explicit Pipeline(std::size_t threads = 1)
+        : groups(threads == 0 ? 1 : threads), next(0), failed(false)
+    {}
+
+    void spawn(Stage&& stage)
+    {
+        spawn(std::move(stage), next++ % groups.size());
+    }
+
+    void spawn(Stage&& stage, std::size_t thread)
+    {
+        groups[thread % groups.size()].push_back(std::move(stage));
+    }
+
+    // Runs every stage to completion, or until one throws, and rethrows the first error.
+    void run()
+    {
+        failed = false;
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < groups.size(); ++i)
+            threads.push_back(std::thread(&Pipeline::runGroup, this, std::ref(groups[i])));
+        runGroup(groups[0]);
+        for (std::size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+
+        std::exception_ptr error;
+        for (std::size_t i = 0; i < groups.size(); ++i)
+        {
+            for (std::size_t k = 0; k < groups[i].size() && !error; ++k)
+                error = groups[i][k].error();
+            groups[i].clear();
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    void runGroup(std::vector<Stage>& stages)
+    {
+        std::size_t running = stages.size();
+        while (running > 0 && !failed.load(std::memory_order_relaxed))
+        {
+            bool progress = false;
+            running = 0;
+            for (std::size_t i = 0; i < stages.size(); ++i)
+            {
+                if (stages[i].done())
+                    continue;
+                progress |= stages[i].step();
+                if (!stages[i].done())
+                    ++running;
+                else if (stages[i].error())
+                    failed = true;
+            }
+            // Everything here waits on stages running on other threads.
+            if (!progress)
+                std::this_thread::yield();
+        }
+    }
+
+    std::vector<std::vector<Stage>> groups;
+    std::size_t next;
+    std::atomic<bool> failed;
+};
+
+/*
+* Stock stages. Each one closes its output when done, so they chain.
+*/
+template <class N>
+Stage source(const N* first, const N* last, Channel<N>& out)
+{
+    while (first != last)
+    {
+        const std::size_t n = std::min<std::size_t>(last - first, out.batchSize());
+        co_await out.push(Batch<N>(first, first + n));
+        first += n;
+    }
+    out.close();
+}
+
+// Parses whitespace separated UnderlyingType values.
+template <class N>
+Stage parse(std::istream& in, Channel<N>& out)
+{
+    typename N::UnderlyingType value;
+    Batch<N> batch;
+    batch.reserve(out.batchSize());
+    while (in >> value)
+    {
+        batch.push_back(N(value));
+        if (batch.size() == out.batchSize())
+        {
+            co_await out.push(std::move(batch));
+            batch = Batch<N>();
+            batch.reserve(out.batchSize());
+        }
+    }
+    if (!batch.empty())
+        co_await out.push(std::move(batch));
+    out.close();
+}
+
+template <class N, class M, class F>
+Stage transform(Channel<N>& in, Channel<M>& out, F f)
+{
+    while (std::optional<Batch<N>> batch = co_await in.pop())
+    {
+        Batch<M> result;
+        result.reserve(batch->size());
+        for (const N& value : *batch)
+            result.push_back(f(value));
+        co_await out.push(std::move(result));
+    }
+    out.close();
+}
+
+// Keeps the values for which pred holds, by default the LogicalAspect's truthy ones.
+template <class N, class P>
+Stage filter(Channel<N>& in, Channel<N>& out, P pred)
+{
+    while (std::optional<Batch<N>> batch = co_await in.pop())
+    {
+        std::size_t kept = 0;
+        for (N& value : *batch)
+            if (pred(value))
+                (*batch)[kept++] = value;
+        batch->erase(batch->begin() + kept, batch->end());
+        if (kept > 0)
+            co_await out.push(std::move(*batch));
+    }
+    out.close();
+}
+
+template <class N>
+Stage filter(Channel<N>& in, Channel<N>& out)
+{
+    return filter(in, out, [](const N& value) { return !!value; });
+}
+
+template <class N, class Op>
+Stage aggregate(Channel<N>& in, N& result, Op op)
+{
+    while (std::optional<Batch<N>> batch = co_await in.pop())
+        for (const N& value : *batch)
+            result = op(result, value);
+}
+
+}
+}
+
+#endif
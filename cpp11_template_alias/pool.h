@@ -0,0 +1,353 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+
+namespace aop
+{
+
+/*
+* Bump allocator: memory is handed out linearly from big chunks and is
+* given back all at once, by rewinding to a mark or by reset(). Chunks
+* are linked through a header at their start, so each one costs a
+* single global allocation.
+*/
+class Arena
+{
+    struct Chunk;
+
+public:
+    struct Mark
+    {
+        Chunk* chunk;
+        std::size_t offset;
+    };
+
+    explicit Arena(std::size_t chunkSize = 64 * 1024)
+        : chunkSize(chunkSize), first(NULL), last(NULL), chunk(NULL), offset(0), count(0)
+    {}
+
+    ~Arena()
+    {
+        while (first != NULL)
+        {
+            Chunk* next = first->next;
+            ::operator delete(first);
+            first = next;
+        }
+    }
+
+    void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t))
+    {
+        ++count;
+        if (chunk == NULL)
+            chunk = first;
+        for (;;)
+        {
+            if (chunk != NULL)
+            {
+                // Aligns the address: operator new only guarantees max_align_t.
+                const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(chunk->data() + offset);
+                const std::size_t aligned = offset + ((align - (address & (align - 1))) & (align - 1));
+                if (aligned + size <= chunk->size)
+                {
+                    offset = aligned + size;
+                    return chunk->data() + aligned;
+                }
+                if (chunk->next == NULL)
+                    append(std::max(chunkSize, size + align));
+                chunk = chunk->next;
+            }
+            else
+                chunk = append(std::max(chunkSize, size + align));
+            offset = 0;
+        }
+    }
+
+    Mark mark() const
+    {
+        const Mark m = { chunk, offset };
+        return m;
+    }
+
+    // Chunks are kept for reuse, only the cursor moves back.
+    void rewind(const Mark& m)
+    {
+        chunk = m.chunk;
+        offset = m.offset;
+    }
+
+    void reset()
+    {
+        chunk = NULL;
+        offset = 0;
+    }
+
+    std::size_t allocations() const
+    {
+        return count;
+    }
+
+    static Arena& current()
+    {
+        static thread_local Arena arena;
+        return arena;
+    }
+
+private:
+    struct Chunk
+    {
+        Chunk* next;
+        std::size_t size;
+
+        char* data()
+        {
+            return reinterpret_cast<char*>(this + 1);
+        }
+    };
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    Chunk* append(std::size_t size)
+    {
+        Chunk* added = static_cast<Chunk*>(::operator new(sizeof(Chunk) + size));
+        added->next = NULL;
+        added->size = size;
+        if (last != NULL)
+            last->next = added;
+        else
+            first = added;
+        last = added;
+        return added;
+    }
+
+    const std::size_t chunkSize;
+    Chunk* first;
+    Chunk* last;
+    Chunk* chunk;
+    std::size_t offset;
+    std::size_t count;
+};
+
+/*
+* Rewinds the arena on scope exit; meant to wrap a whole request.
+*/
+class ArenaScope
+{
+public:
+    explicit ArenaScope(Arena& arena = Arena::current())
+        : arena(arena), start(arena.mark())
+    {}
+
+    ~ArenaScope()
+    {
+        arena.rewind(start);
+    }
+
+private:
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    Arena& arena;
+    const Arena::Mark start;
+};
+
+/*
+* Standard allocator over an Arena, for the buffers of heap backed
+* underlying types. Deallocation is a no-op.
+*/
+template <class T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    ArenaAllocator()
+        : arena(&Arena::current())
+    {}
+
+    explicit ArenaAllocator(Arena& arena)
+        : arena(&arena)
+    {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : arena(other.arena)
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, std::size_t)
+    {}
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return arena == other.arena;
+    }
+
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return arena != other.arena;
+    }
+
+    Arena* arena;
+};
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> > ArenaString;
+
+/*
+* Thread local size class pool: one free list per 16 byte class, blocks
+* carved out of a private arena. Blocks must be freed by the thread that
+* allocated them. Freed blocks are recycled one at a time through the
+* free lists; the private arena is never rewound, so an ArenaScope does
+* not bulk-free pooled values.
+*/
+class Pool
+{
+public:
+    static const std::size_t Granularity = 16;
+    static const std::size_t MaxSize = 256;
+
+    Pool()
+        : freeLists()
+    {}
+
+    void* allocate(std::size_t size)
+    {
+        if (size > MaxSize)
+            return ::operator new(size);
+
+        FreeBlock*& head = freeLists[sizeClass(size)];
+        if (head != NULL)
+        {
+            FreeBlock* block = head;
+            head = block->next;
+            return block;
+        }
+        return arena.allocate((sizeClass(size) + 1) * Granularity, Granularity);
+    }
+
+    void deallocate(void* p, std::size_t size)
+    {
+        if (p == NULL)
+            return;
+
+        if (size > MaxSize)
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = freeLists[sizeClass(size)];
+        freeLists[sizeClass(size)] = block;
+    }
+
+    static Pool& current()
+    {
+        static thread_local Pool pool;
+        return pool;
+    }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    static std::size_t sizeClass(std::size_t size)
+    {
+        return size == 0 ? 0 : (size - 1) / Granularity;
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    Arena arena;
+    FreeBlock* freeLists[MaxSize / Granularity];
+};
+}
+
+/*
+* Heap allocated decorated values come from the thread local Pool.
+*/
+template <class A>
+class PooledAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    PooledAspect(typename A::UnderlyingType n)
+        : A(n)
+    {}
+
+    PooledAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    static void* operator new(std::size_t size)
+    {
+        return aop::Pool::current().allocate(size);
+    }
+
+    static void operator delete(void* p, std::size_t size)
+    {
+        aop::Pool::current().deallocate(p, size);
+    }
+
+    static void* operator new[](std::size_t size)
+    {
+        return aop::Pool::current().allocate(size);
+    }
+
+    static void operator delete[](void* p, std::size_t size)
+    {
+        aop::Pool::current().deallocate(p, size);
+    }
+};
+
+#endif
@@ -0,0 +1,244 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "aop.h"
+#include "aspects.h"
+#include "parallel.h"
+
+namespace aop
+{
+
+/*
+* Scans run on the element type's operators. When they are the stock
+* +, | or & of a 32 bit integer underlying type, with no other aspect in
+* the stack redefining them, four values at a time are scanned inside an
+* SSE2 register with two shift-and-combine steps.
+*/
+template <class Op>
+struct SimdScanOp;
+
+#if defined(__SSE2__)
+template <>
+struct SimdScanOp<parallel::Plus>
+{
+    template <class N>
+    struct Permits : HasPlainAspect<N, ArithmeticAspect>
+    {};
+
+    static __m128i combine(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+    static __m128i identity() { return _mm_setzero_si128(); }
+};
+
+template <>
+struct SimdScanOp<parallel::BitwiseOr>
+{
+    template <class N>
+    struct Permits : HasPlainAspect<N, BitwiseAspect>
+    {};
+
+    static __m128i combine(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+    static __m128i identity() { return _mm_setzero_si128(); }
+};
+
+template <>
+struct SimdScanOp<parallel::BitwiseAnd>
+{
+    template <class N>
+    struct Permits : HasPlainAspect<N, BitwiseAspect>
+    {};
+
+    static __m128i combine(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+    static __m128i identity() { return _mm_set1_epi32(-1); }
+};
+#endif
+
+template <class N, class Op, class = void>
+struct SimdScan
+{
+    static const bool value = false;
+};
+
+template <class N, class Op>
+struct SimdScan<N, Op, decltype(void(SimdScanOp<Op>::identity()))>
+{
+    typedef typename N::UnderlyingType T;
+    static const bool value = std::is_integral<T>::value && sizeof(T) == 4
+        && std::is_standard_layout<N>::value && sizeof(N) == sizeof(T)
+        && SimdScanOp<Op>::template Permits<N>::value;
+};
+
+/*
+* Scans n values starting from carry: out[i] is carry op in[0] op ... op
+* in[i] (inclusive) or carry op ... op in[i - 1] (exclusive). Returns the
+* carry for the next block. out may be in.
+*/
+template <class N, class Op>
+N scanBlock(const N* in, std::size_t n, N* out, N carry, bool exclusive, Op op, std::false_type)
+{
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const N next = op(carry, in[i]);
+        out[i] = exclusive ? carry : next;
+        carry = next;
+    }
+    return carry;
+}
+
+#if defined(__SSE2__)
+template <class N, class Op>
+N scanBlock(const N* in, std::size_t n, N* out, N carry, bool exclusive, Op op, std::true_type)
+{
+    typedef SimdScanOp<Op> S;
+    const __m128i identity = S::identity();
+    const __m128i low1 = _mm_srli_si128(identity, 12);
+    const __m128i low2 = _mm_srli_si128(identity, 8);
+    __m128i carries = _mm_set1_epi32(int(underlying(carry)));
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        x = S::combine(x, _mm_or_si128(_mm_slli_si128(x, 4), low1));
+        x = S::combine(x, _mm_or_si128(_mm_slli_si128(x, 8), low2));
+        x = S::combine(x, carries);
+        const __m128i result = exclusive ? _mm_or_si128(_mm_slli_si128(x, 4), _mm_srli_si128(carries, 12)) : x;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+        carries = _mm_shuffle_epi32(x, 0xff);
+    }
+    underlying(carry) = typename N::UnderlyingType(_mm_cvtsi128_si32(carries));
+    return scanBlock(in + i, n - i, out + i, carry, exclusive, op, std::false_type());
+}
+#endif
+
+template <class N, class Op>
+N scanBlock(const N* in, std::size_t n, N* out, N carry, bool exclusive, Op op)
+{
+    return scanBlock(in, n, out, carry, exclusive, op, std::integral_constant<bool, SimdScan<N, Op>::value>());
+}
+
+template <class N, class Op>
+void inclusive_scan(const N* first, const N* last, N* out, Op op)
+{
+    if (first != last)
+        scanBlock(first + 1, last - first - 1, out + 1, out[0] = first[0], false, op);
+}
+
+template <class N>
+void inclusive_scan(const N* first, const N* last, N* out)
+{
+    inclusive_scan(first, last, out, parallel::Plus());
+}
+
+template <class N, class Op>
+void exclusive_scan(const N* first, const N* last, N* out, N init, Op op)
+{
+    scanBlock(first, last - first, out, init, true, op);
+}
+
+template <class N>
+void exclusive_scan(const N* first, const N* last, N* out, N init)
+{
+    exclusive_scan(first, last, out, init, parallel::Plus());
+}
+
+namespace parallel
+{
+
+/*
+* Two passes over fixed chunks: reduce every chunk in parallel, scan the
+* chunk totals, then scan every chunk again from its carry in parallel.
+*/
+template <class N, class Op>
+void scan(ThreadPool& pool, const N* first, const N* last, N* out, N init, bool exclusive, Op op)
+{
+    const std::size_t n = last - first;
+    if (n <= ChunkSize)
+    {
+        scanBlock(first, n, out, init, exclusive, op);
+        return;
+    }
+
+    std::vector<N> carries(chunks(n), init);
+    N* carry = &carries[0];
+    pool.run(carries.size() - 1, [=](std::size_t c) {
+        const N* chunk = first + c * ChunkSize;
+        N total = chunk[0];
+        for (std::size_t i = 1; i < ChunkSize; ++i)
+            total = op(total, chunk[i]);
+        carry[c + 1] = total;
+    });
+    for (std::size_t c = 1; c < carries.size(); ++c)
+        carries[c] = op(carries[c - 1], carries[c]);
+
+    pool.run(carries.size(), [=](std::size_t c) {
+        const std::size_t begin = c * ChunkSize;
+        const std::size_t size = std::min(n - begin, ChunkSize);
+        scanBlock(first + begin, size, out + begin, carry[c], exclusive, op);
+    });
+}
+
+template <class N, class Op>
+void inclusive_scan(ThreadPool& pool, const N* first, const N* last, N* out, Op op)
+{
+    if (first != last)
+        scan(pool, first + 1, last, out + 1, out[0] = first[0], false, op);
+}
+
+template <class N>
+void inclusive_scan(ThreadPool& pool, const N* first, const N* last, N* out)
+{
+    inclusive_scan(pool, first, last, out, Plus());
+}
+
+template <class N, class Op>
+void exclusive_scan(ThreadPool& pool, const N* first, const N* last, N* out, N init, Op op)
+{
+    scan(pool, first, last, out, init, true, op);
+}
+
+template <class N>
+void exclusive_scan(ThreadPool& pool, const N* first, const N* last, N* out, N init)
+{
+    exclusive_scan(pool, first, last, out, init, Plus());
+}
+}
+}
+
+#endif
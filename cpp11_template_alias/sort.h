@@ -0,0 +1,295 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef SORT_H
+#define SORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#include "aop.h"
+#include "aspects.h"
+
+namespace aop
+{
+
+/*
+* Sorting network for 16 values of a 32 bit integer type in four SSE4.1
+* registers: the columns are sorted with min/max across registers, the
+* registers transposed into four sorted runs of four, and the runs
+* merged with bitonic merges, all without a branch.
+*/
+#if defined(__SSE4_1__)
+template <bool Signed>
+struct SimdMinMax
+{
+    static __m128i min(__m128i a, __m128i b) { return _mm_min_epi32(a, b); }
+    static __m128i max(__m128i a, __m128i b) { return _mm_max_epi32(a, b); }
+};
+
+template <>
+struct SimdMinMax<false>
+{
+    static __m128i min(__m128i a, __m128i b) { return _mm_min_epu32(a, b); }
+    static __m128i max(__m128i a, __m128i b) { return _mm_max_epu32(a, b); }
+};
+
+template <class M>
+inline void compareExchange(__m128i& a, __m128i& b)
+{
+    const __m128i low = M::min(a, b);
+    b = M::max(a, b);
+    a = low;
+}
+
+inline __m128i reverse(__m128i x)
+{
+    return _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+// Sorts a bitonic sequence of four lanes.
+template <class M>
+inline __m128i bitonicClean(__m128i x)
+{
+    __m128i y = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2));
+    x = _mm_blend_epi16(M::min(x, y), M::max(x, y), 0xf0);
+    y = _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_blend_epi16(M::min(x, y), M::max(x, y), 0xcc);
+}
+
+// Merges the sorted runs a and b into a (low half) and b (high half).
+template <class M>
+inline void bitonicMerge(__m128i& a, __m128i& b)
+{
+    b = reverse(b);
+    compareExchange<M>(a, b);
+    a = bitonicClean<M>(a);
+    b = bitonicClean<M>(b);
+}
+
+template <class M>
+inline void sortingNetwork16(__m128i& a, __m128i& b, __m128i& c, __m128i& d)
+{
+    compareExchange<M>(a, b);
+    compareExchange<M>(c, d);
+    compareExchange<M>(a, c);
+    compareExchange<M>(b, d);
+    compareExchange<M>(b, c);
+
+    const __m128i ab0 = _mm_unpacklo_epi32(a, b);
+    const __m128i ab1 = _mm_unpackhi_epi32(a, b);
+    const __m128i cd0 = _mm_unpacklo_epi32(c, d);
+    const __m128i cd1 = _mm_unpackhi_epi32(c, d);
+    a = _mm_unpacklo_epi64(ab0, cd0);
+    b = _mm_unpackhi_epi64(ab0, cd0);
+    c = _mm_unpacklo_epi64(ab1, cd1);
+    d = _mm_unpackhi_epi64(ab1, cd1);
+
+    bitonicMerge<M>(a, b);
+    bitonicMerge<M>(c, d);
+
+    // 8 + 8: the reversed second run against the first, then each half
+    // is a bitonic sequence of eight.
+    __m128i e = reverse(d);
+    __m128i f = reverse(c);
+    compareExchange<M>(a, e);
+    compareExchange<M>(b, f);
+    compareExchange<M>(a, b);
+    compareExchange<M>(e, f);
+    a = bitonicClean<M>(a);
+    b = bitonicClean<M>(b);
+    c = bitonicClean<M>(e);
+    d = bitonicClean<M>(f);
+}
+
+/*
+* Sorts up to 16 values; missing lanes are padded with the largest value
+* and left out of the store.
+*/
+template <class N>
+void networkSort(N* first, std::size_t n)
+{
+    typedef typename N::UnderlyingType T;
+    typedef SimdMinMax<std::is_signed<T>::value> M;
+
+    T values[16];
+    std::memcpy(values, first, n * sizeof(T));
+    std::fill(values + n, values + 16, std::numeric_limits<T>::max());
+
+    __m128i* lanes = reinterpret_cast<__m128i*>(values);
+    __m128i a = _mm_loadu_si128(lanes);
+    __m128i b = _mm_loadu_si128(lanes + 1);
+    __m128i c = _mm_loadu_si128(lanes + 2);
+    __m128i d = _mm_loadu_si128(lanes + 3);
+    sortingNetwork16<M>(a, b, c, d);
+    _mm_storeu_si128(lanes, a);
+    _mm_storeu_si128(lanes + 1, b);
+    _mm_storeu_si128(lanes + 2, c);
+    _mm_storeu_si128(lanes + 3, d);
+    std::memcpy(first, values, n * sizeof(T));
+}
+#endif
+
+template <class N>
+struct SimdSort
+{
+    typedef typename N::UnderlyingType T;
+#if defined(__SSE4_1__)
+    static const bool value = std::is_integral<T>::value && sizeof(T) == 4
+        && std::is_trivially_copyable<N>::value && sizeof(N) == sizeof(T)
+        && HasPlainAspect<N, ComparisonAspect>::value;
+#else
+    static const bool value = false;
+#endif
+};
+
+/*
+* LSD radix sort on the underlying integer, one byte per pass. Passes
+* where every value shares the digit are skipped.
+*/
+template <class N>
+void radixSort(N* first, N* last)
+{
+    typedef typename N::UnderlyingType T;
+    typedef typename std::make_unsigned<T>::type Key;
+    static_assert(std::is_integral<T>::value, "radixSort needs an integral underlying type");
+
+    const std::size_t n = last - first;
+    if (n < 2)
+        return;
+
+    const Key flip = std::is_signed<T>::value ? Key(Key(1) << (8 * sizeof(T) - 1)) : Key(0);
+    std::vector<std::size_t> counts(sizeof(T) * 256);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const Key key = Key(underlying(first[i])) ^ flip;
+        for (std::size_t b = 0; b < sizeof(T); ++b)
+            ++counts[b * 256 + ((key >> (8 * b)) & 0xff)];
+    }
+
+    std::vector<N> buffer(first, last);
+    N* from = first;
+    N* to = &buffer[0];
+    for (std::size_t b = 0; b < sizeof(T); ++b)
+    {
+        std::size_t* count = &counts[b * 256];
+        const Key sample = Key(underlying(*from)) ^ flip;
+        if (count[(sample >> (8 * b)) & 0xff] == n)
+            continue;
+
+        std::size_t offset = 0;
+        for (std::size_t d = 0; d < 256; ++d)
+        {
+            const std::size_t c = count[d];
+            count[d] = offset;
+            offset += c;
+        }
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const Key key = Key(underlying(from[i])) ^ flip;
+            to[count[(key >> (8 * b)) & 0xff]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+    if (from != first)
+        std::copy(from, from + n, first);
+}
+
+template <class N>
+void sortLarge(N* first, N* last, std::true_type)
+{
+    radixSort(first, last);
+}
+
+template <class N>
+void sortLarge(N* first, N* last, std::false_type)
+{
+    std::sort(first, last);
+}
+
+template <class N>
+void sortSmall(N* first, N* last, std::true_type)
+{
+#if defined(__SSE4_1__)
+    if (last - first <= 16)
+        return networkSort(first, last - first);
+#endif
+    std::sort(first, last);
+}
+
+template <class N>
+void sortSmall(N* first, N* last, std::false_type)
+{
+    std::sort(first, last);
+}
+
+/*
+* Picks the algorithm by size and type: the SIMD network for up to 16
+* values and radix sort for large ranges, both for integral types
+* ordered by the stock ComparisonAspect, std::sort otherwise.
+*/
+template <class N>
+void sort(N* first, N* last)
+{
+    const std::size_t n = last - first;
+    if (n < 256)
+        sortSmall(first, last, std::integral_constant<bool, SimdSort<N>::value>());
+    else
+        sortLarge(first, last, std::integral_constant<bool, std::is_integral<typename N::UnderlyingType>::value
+            && HasPlainAspect<N, ComparisonAspect>::value>());
+}
+
+/*
+* Lower bound without a data dependent branch: the search range halves
+* every step and only a conditional move picks the half.
+*/
+template <class N>
+const N* branchlessLowerBound(const N* first, const N* last, const N& value)
+{
+    std::size_t n = last - first;
+    if (n == 0)
+        return first;
+    while (n > 1)
+    {
+        const std::size_t half = n / 2;
+        first = first[half] < value ? first + half : first;
+        n -= half;
+    }
+    return first + (*first < value);
+}
+}
+
+#endif
@@ -0,0 +1,189 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef SUM_H
+#define SUM_H
+
+#include <cmath>
+#include <cstddef>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+#include "aop.h"
+
+namespace aop
+{
+
+/*
+* Pairwise summation: ranges are halved down to blocks, each block is
+* summed in 16 independent lanes and the lanes and halves are added in a
+* tree. The error grows with the log of the size instead of the size,
+* and the lanes keep the vector units busy.
+*/
+static const std::size_t PairwiseBlock = 256;
+
+template <class T>
+T pairwiseBlock(const T* values, std::size_t n)
+{
+    T lanes[16] = {};
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        for (std::size_t j = 0; j < 16; ++j)
+            lanes[j] += values[i + j];
+    for (std::size_t j = 0; i < n; ++i, ++j)
+        lanes[j] += values[i];
+    for (std::size_t width = 8; width > 0; width /= 2)
+        for (std::size_t j = 0; j < width; ++j)
+            lanes[j] += lanes[j + width];
+    return lanes[0];
+}
+
+#if defined(__SSE__)
+inline float pairwiseBlock(const float* values, std::size_t n)
+{
+    __m128 a = _mm_setzero_ps(), b = _mm_setzero_ps(), c = _mm_setzero_ps(), d = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        a = _mm_add_ps(a, _mm_loadu_ps(values + i));
+        b = _mm_add_ps(b, _mm_loadu_ps(values + i + 4));
+        c = _mm_add_ps(c, _mm_loadu_ps(values + i + 8));
+        d = _mm_add_ps(d, _mm_loadu_ps(values + i + 12));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d)));
+    float tail = 0;
+    for (; i < n; ++i)
+        tail += values[i];
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + tail;
+}
+#endif
+
+template <class T>
+T pairwiseSum(const T* values, std::size_t n)
+{
+    if (n <= PairwiseBlock)
+        return pairwiseBlock(values, n);
+    // Split on a block boundary so every block but the last is full.
+    const std::size_t half = (n / 2 + PairwiseBlock - 1) / PairwiseBlock * PairwiseBlock;
+    return pairwiseSum(values, half) + pairwiseSum(values + half, n - half);
+}
+
+/*
+* Neumaier's variant of Kahan summation: the low order bits every
+* addition loses are kept in a compensation term, also when the new value
+* is larger than the running sum. The compensation is itself compensated
+* (Klein's second order scheme), otherwise over millions of additions its
+* own rounding errors pile up in float.
+*/
+template <class T>
+class CompensatedSum
+{
+public:
+    explicit CompensatedSum(T initial = T())
+        : sum(initial), compensation(), secondOrder()
+    {}
+
+    CompensatedSum& operator+=(T value)
+    {
+        const T lost = add(sum, value);
+        secondOrder += add(compensation, lost);
+        return *this;
+    }
+
+    T total() const
+    {
+        return sum + (compensation + secondOrder);
+    }
+
+private:
+    // Adds value to sum and returns what the addition lost.
+    static T add(T& sum, T value)
+    {
+        const T t = sum + value;
+        const T lost = std::abs(sum) >= std::abs(value) ? (sum - t) + value : (value - t) + sum;
+        sum = t;
+        return lost;
+    }
+
+    T sum;
+    T compensation;
+    T secondOrder;
+};
+}
+
+/*
+* Accurate sums of floating point numbers: Accumulator adds one value at
+* a time with compensation, sum() adds a whole array pairwise.
+*/
+template <class A>
+class CompensatedSumAspect: public A
+{
+public:
+    typedef typename A::FullType FullType;
+    typedef typename A::UnderlyingType UnderlyingType;
+
+#ifdef INHERITING_CTORS
+    using A::A;
+#else
+    CompensatedSumAspect(UnderlyingType n)
+        : A(n)
+    {}
+
+    CompensatedSumAspect(const A& a)
+        : A(a)
+    {}
+#endif
+
+    class Accumulator
+    {
+    public:
+        Accumulator& operator+=(const FullType& value)
+        {
+            sum += aop::underlying(value);
+            return *this;
+        }
+
+        FullType total() const
+        {
+            return FullType(sum.total());
+        }
+
+    private:
+        aop::CompensatedSum<UnderlyingType> sum;
+    };
+
+    static FullType sum(const FullType* values, std::size_t n)
+    {
+        return FullType(n == 0 ? UnderlyingType() : aop::pairwiseSum(&aop::underlying(values[0]), n));
+    }
+};
+
+#endif
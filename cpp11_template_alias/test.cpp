@@ -28,271 +28,387 @@
     THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <cstdio>
 #include <iostream>
-#include <cmath>
-#include "aop.h"
-
-//#define INHERITING_CTORS  as of g++ 6.4.3, inheriting ctors was not implemented
+#include <vector>
+#include "aspects.h"
+#include "bigint.h"
+#include "binary.h"
+#include "bitset.h"
+#include "cached.h"
+#include "compressed.h"
+#include "dynamic.h"
+#include "filter.h"
+#include "flatmap.h"
+#include "intern.h"
+#include "matrix.h"
+#include "memo.h"
+#include "parallel.h"
+#include "scan.h"
+#include "sort.h"
+#include "sum.h"
+#include "window.h"
+#if __cplusplus >= 201703L
+#include <string>
+#include "format.h"
+#endif
+#if __cplusplus >= 202002L
+#include <sstream>
+#include "pipeline.h"
+#endif
+#include "pool.h"
 
-template <typename _UnderlyingType>
-struct Number
+template <class N>
+void sumExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
 {
-    template <template <class> class A = aop::NullAspect>
-    class Type
-    {
-    public:
-        typedef _UnderlyingType UnderlyingType;
-        typedef A<Number::Type<A>> FullType;
-
-        Type(UnderlyingType n)
-            : n(n)
-        {}
-
-        friend std::ostream& operator<<(std::ostream& out, const Type& number)
-        {
-            return out << number.n;
-        }
-    protected:
-        UnderlyingType n;
-    };
-};
+    N a(n1);
+    N b(n2);
+    N c = a + b;
+    std::cout << c << std::endl;
+}
 
-template <class A>
-class ArithmeticAspect: public A
+template <class N>
+void orExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
 {
-public:
-    typedef typename A::FullType FullType;
-
-#ifdef INHERITING_CTORS
-    using A::A;
-#else
-    ArithmeticAspect(typename A::UnderlyingType n)
-        : A(n)
-    {}
-
-    ArithmeticAspect(const A& a)
-        : A(a)
-    {}
-#endif
+    N a(n1);
+    N b(n2);
+    std::cout << (a || b) << " " << (0 || b) << " " << (1 && b) << std::endl;
+}
 
-    FullType operator+(const FullType& other) const
-    {
-        FullType tmp(*this);
-        return tmp += other;
-    }
+template <class N>
+void bitwiseExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    N a(n1);
+    N b(n2);
+    std::cout << (a + ((b >>= 1) << 3)) << std::endl;
+}
 
-    FullType operator-(const FullType& other) const
-    {
-        FullType tmp(*this);
-        return tmp -= other;
-    }
+template <class N>
+void shiftExample(typename N::UnderlyingType n, typename N::UnderlyingType bits)
+{
+    N a(n);
+    N b(bits);
+    std::cout << ((a << b) | a) << std::endl;
+}
 
-    FullType operator+=(const FullType& other)
-    {
-        A::n += other.n;
-        return A::n;
-    }
+template <class N>
+void mixedExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    N a(n1);
+    N b(n2);
+    std::cout << (a + 1) << " " << (2 + b) << " " << ((b >>= 1) << 3) << " "
+              << (a << aop::Constant<4>()) << " " << (a | 0x100) << std::endl;
+}
 
-    FullType operator-=(const FullType& other)
-    {
-        A::n -= other.n;
-        return A::n;
-    }
+template <class N>
+void mixedComparisonExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    N a(n1);
+    std::cout << (a < n2) << " " << (n2 <= a) << " " << (a == n1) << " " << (a - 1 != n1) << std::endl;
+}
 
-    // same for *, *=, /, /=
-};
+template <class N1, class N2>
+void heterogeneousExample(typename N1::UnderlyingType n1, typename N2::UnderlyingType n2)
+{
+    N1 a(n1);
+    N2 b(n2);
+    typedef typename CommonNumber<N1, N2>::Type R;
+    const R sum = a + b;
+    std::cout << sum << " " << (b - a) << " " << aop::aspect_count<R>::value << " " << (a < b) << " "
+              << aop::has_aspect<R, BitwiseAspect>::value << std::endl;
+}
 
-template <class A>
-class IncrementalAspect: public A
+template <class N>
+void chainExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
 {
-public:
-    typedef typename A::FullType FullType;
-
-#ifdef INHERITING_CTORS
-    using A::A;
-#else
-    IncrementalAspect(typename A::UnderlyingType n)
-        : A(n)
-    {}
-
-    IncrementalAspect(const A& a)
-        : A(a)
-    {}
-#endif
+    N a(n1);
+    N b(n2);
+    N chain = a + b + a + b + a + b + a + b;
+    N difference = a + b - a;
+    std::cout << chain << " " << (a + b + a) << " " << difference << std::endl;
+}
 
-    FullType operator++(int)
+template <class N>
+void compensatedSumExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    std::vector<N> values;
+    typename N::Accumulator accumulator;
+    N naive(0);
+    for (int i = 0; i < 1000000; ++i)
     {
-        FullType tmp(*this);
-        operator++();
-        return tmp;
+        values.push_back(N(i % 2 == 0 ? n1 : n2));
+        accumulator += values.back();
+        naive += values.back();
     }
+    std::cout << naive << " " << accumulator.total() << " " << N::sum(&values[0], values.size()) << std::endl;
+}
 
-    FullType operator++()
-    {
-        ++A::n;
-        return *this;
-    }
+template <class N>
+void bitsetExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    N a(n1);
+    N b(n2);
+    N c = (a << 100) | b;
+    std::cout << c.popcount() << " " << c.findFirst() << " " << c.rank(100) << " " << (~c).popcount() << " " << (c >> 100).findFirst() << std::endl;
+    std::cout << N(-1).popcount() << " " << (a << (b << 64)).popcount() << std::endl;
+}
 
-    FullType operator--(int)
-    {
-        FullType tmp(*this);
-        operator--();
-        return tmp;
-    }
+template <class N>
+void matrixExample(typename N::UnderlyingType::Element first)
+{
+    typename N::UnderlyingType m;
+    for (std::size_t r = 0; r < N::UnderlyingType::Rows; ++r)
+        for (std::size_t c = 0; c < N::UnderlyingType::Columns; ++c)
+            m(r, c) = first + r + c / 3.0f;
+    N a(m);
+    N b(0.005f);
+    N d = a + b - a;
+    std::cout << (a + b) << " " << (a + b + 1) << " " << d << " " << (aop::underlying(a) * aop::underlying(a)) << std::endl;
+}
+
+template <class N>
+void internExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    std::vector<N> values;
+    for (int i = 0; i < 1000; ++i)
+        values.push_back(N(i % 3 == 0 ? n1 : n2));
+    const N sum = values[0] + values[1];
+    std::cout << sum << " " << (values[0] == values[3]) << " " << (values[1] == values[2]) << " "
+              << (values[0] < values[1]) << " " << (&values[0].value() == &values[999].value()) << " " << N::distinct() << std::endl;
+}
+
+// Derives the hash of HashAspect, counting how often it is computed.
+struct CountedHash
+{
+    typedef std::size_t Result;
+    static int computed;
 
-    FullType operator--()
+    template <class N>
+    std::size_t operator()(const N& n) const
     {
-        --A::n;
-        return *this;
+        ++computed;
+        return n.hash();
     }
 };
 
-/*
-* Configurable Aspect sumExample
-*/
-template <unsigned int PRECISION>
-struct RoundAspect
-{
-    template <class A>
-    class Type : public A
-    {
-    public:
-        typedef typename A::FullType FullType;
-
-#ifdef INHERITING_CTORS
-        using A::A;
-#else
-        Type(typename A::UnderlyingType n)
-            : A(n)
-        {}
-
-        Type(const A& a)
-            : A(a)
-        {}
-#endif
+int CountedHash::computed = 0;
 
-        FullType operator+(const FullType& other) const
-        {
-            return FullType(round(A::operator+(other).n));
-        }
-
-    private:
-        static float round(float f)
-        {
-            const unsigned int e = std::pow(10, PRECISION);
-            return float(int(f * e)) / e;
-        }
-    };
-};
+template <class N>
+void cachedExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    N a(n1);
+    N b(n2);
+    const bool same = a.derived() == a.derived();
+    a += b;
+    const bool changed = a.derived() != N(n1).derived();
+    const N c = a + b;
+    c.derived();
+    std::cout << same << " " << changed << " " << (a.derived() == N(n1 + n2).derived()) << " " << CountedHash::computed << std::endl;
+}
 
-template <class A>
-class LogicalAspect: public A
+template <class N>
+void poolExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
 {
-public:
-    typedef typename A::FullType FullType;
-
-#ifdef INHERITING_CTORS
-    using A::A;
-#else
-    LogicalAspect(typename A::UnderlyingType n)
-        : A(n)
-    {}
-
-    LogicalAspect(const A& a)
-        : A(a)
-    {}
-#endif
+    aop::ArenaScope request;
+    N* a = new N(n1);
+    N b(n2);
+    aop::Arena::current().allocate(1, 1);
+    const void* wide = aop::Arena::current().allocate(1, 4096);
+    std::cout << (*a + b) << " " << reinterpret_cast<std::uintptr_t>(wide) % 4096 << std::endl;
+    delete a;
+}
 
-    bool operator!() const
+template <class N>
+void binaryExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    const N values[] = { N(n1), N(n2), N(n1) + N(n2) };
+    aop::writeBinary("test_aop_binary.bin", values, 3);
     {
-        return !A::n;
+        const aop::MappedArray<N> mapped("test_aop_binary.bin");
+        std::cout << mapped.size() << " " << mapped[2] << std::endl;
     }
-
-    bool operator&&(const FullType& other) const
     {
-        return A::n && other.n;
+        aop::BinaryWriter<N> writer("test_aop_binary.bin");
+        writer.push(N(n2));
     }
-
-    bool operator||(const FullType& other) const
     {
-        return A::n || other.n;
+        const aop::MappedArray<N> mapped("test_aop_binary.bin");
+        std::cout << mapped.size() << " " << mapped[0] << std::endl;
     }
-};
+    std::remove("test_aop_binary.bin");
+}
 
-template <class A>
-class BitwiseAspect: public A
+template <class N>
+void compressedExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
 {
-public:
-    typedef typename A::FullType FullType;
-
-#ifdef INHERITING_CTORS
-    using A::A;
-#else
-    BitwiseAspect(typename A::UnderlyingType n)
-        : A(n)
-    {}
-
-    BitwiseAspect(const A& a)
-        : A(a)
-    {}
-#endif
+    std::vector<N> values;
+    for (typename N::UnderlyingType i = 0; i < 1000; ++i)
+        values.push_back(i % 3 == 0 ? N(n1 * i) : N(n2 + i));
+    const aop::CompressedArray<N> compressed(&values[0], values.size());
+
+    N total(0);
+    const N mask(0xff);
+    compressed.forEachBlock([&](const N* block, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i)
+            total += block[i] & mask;
+    });
+    std::cout << compressed.bytes() << " " << total << std::endl;
+}
 
-    bool operator~() const
+template <class N>
+void filterExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    std::vector<N> a, b;
+    for (typename N::UnderlyingType i = 0; i < 10; ++i)
     {
-        return ~A::n;
+        a.push_back(N(i % n1));
+        b.push_back(N(i % n2));
     }
+    const aop::Bitmask mask = aop::logicalAnd(&a[0], &b[0], a.size()) | ~aop::truthMask(&a[0], a.size());
+    const aop::SelectionVector selection = aop::select(mask);
+    std::vector<N> selected(b);
+    aop::gather(&b[0], selection, &selected[0]);
+
+    N total(0);
+    for (std::size_t i = 0; i < selection.size(); ++i)
+        total += selected[i];
+    std::cout << aop::compact(&a[0], mask, &selected[0]) << " " << total << std::endl;
+}
 
-    FullType operator&(const FullType& mask) const
-    {
-        return A::n & mask.n;
-    }
+template <class N>
+void sortExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    std::vector<N> values;
+    for (unsigned int i = 0; i < 1000; ++i)
+        values.push_back(N(typename N::UnderlyingType((i * 7919) % 1000) * n1 - n2));
+    aop::sort(&values[0], &values[0] + values.size());
+    const N* found = aop::branchlessLowerBound(&values[0], &values[0] + values.size(), N(n1));
+    std::cout << values.front() << " " << values.back() << " " << (found - &values[0]) << std::endl;
+}
 
-    FullType operator|(const FullType& mask) const
-    {
-        return A::n | mask.n;
-    }
+template <class N>
+void hashExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    aop::FlatMap<N, unsigned int> counts;
+    for (typename N::UnderlyingType i = 0; i < 1000; ++i)
+        ++counts[N(i % n1)];
+    counts.erase(N(0));
+    const unsigned int* found = counts.find(N(n2));
+
+    aop::FlatSet<N> seen;
+    for (typename N::UnderlyingType i = 0; i < 1000; ++i)
+        seen.insert(N(i % n2));
+    std::cout << counts.size() << " " << *found << " " << counts.contains(N(n1)) << " " << seen.size() << std::endl;
+}
 
-    FullType operator<<(const FullType& bitcount) const
+template <class N>
+void parallelExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    std::vector<N> values(100000, N(n1));
+    aop::parallel::ThreadPool pool(4);
+    aop::parallel::transform(pool, &values[0], &values[0] + values.size(), &values[0], [n2](const N& n) { return n + N(n2); });
+    const N sum = aop::parallel::reduce(pool, &values[0], &values[0] + values.size(), N(0));
+    const N mask = aop::parallel::reduce(pool, &values[0], &values[0] + values.size(), N(0), aop::parallel::BitwiseOr());
+    bool thrown = false;
+    try
     {
-        return A::n << bitcount.n;
+        pool.run(values.size(), [](std::size_t i) { if (i == 7) throw i; });
     }
-
-    FullType operator>>(const FullType& bitcount) const
+    catch (std::size_t)
     {
-        return A::n >> bitcount.n;
+        thrown = true;
     }
+    std::cout << sum << " " << mask << " " << thrown << std::endl;
+}
+
+template <class N>
+void scanExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    std::vector<N> values;
+    for (typename N::UnderlyingType i = 0; i < 100000; ++i)
+        values.push_back(N(i % n1 == 0 ? n2 : 1));
+    std::vector<N> sums(values), masks(values);
+    aop::parallel::ThreadPool pool(4);
+    aop::parallel::inclusive_scan(pool, &values[0], &values[0] + values.size(), &sums[0]);
+    aop::exclusive_scan(&values[0], &values[0] + values.size(), &masks[0], N(0), aop::parallel::BitwiseOr());
+    std::cout << sums[9] << " " << sums.back() << " " << masks[1] << " " << masks.back() << std::endl;
+}
+
+template <class N>
+void memoizeExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+{
+    N total(0);
+    for (int i = 0; i < 100; ++i)
+        total = total + ((N(n1) + N(n2)) - N(n2));
+    std::cout << total << " " << N::statistics().hits << " " << N::statistics().misses << std::endl;
+}
 
-    FullType& operator>>=(const FullType& bitcount)
+template <class N>
+void introspectionExample()
+{
+    std::cout << aop::aspect_count<N>::value << " " << aop::has_aspect<N, BitwiseAspect>::value << " "
+              << aop::aspect_position<N, ArithmeticAspect>::value << " " << aop::SimdScan<N, aop::parallel::Plus>::value << std::endl;
+}
+
+struct SumBatch
+{
+    template <class N>
+    typename N::UnderlyingType operator()(const N* values, std::size_t n) const
     {
-        A::n >>= bitcount.n;
-        return *static_cast<FullType*>(this);
+        N total(0);
+        for (std::size_t i = 0; i < n; ++i)
+            total = total + values[i];
+        return aop::underlying(total);
     }
 };
 
+template <class Semantics>
+void dynamicExample(typename Semantics::UnderlyingType n1, typename Semantics::UnderlyingType n2)
+{
+    const typename Semantics::UnderlyingType values[] = { n1, n2, n1 + n2 };
+    for (std::size_t i = 0; i < Semantics::Count; ++i)
+        std::cout << Semantics(i).apply(values, 3, SumBatch()) << " ";
+    std::cout << std::endl;
+}
+
 template <class N>
-void sumExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+void windowExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
 {
-    N a(n1);
-    N b(n2);
-    N c = a + b;
-    std::cout << c << std::endl;
+    aop::Window<N, 4> window;
+    for (typename N::UnderlyingType i = 0; i < 10; ++i)
+        window.push(N(i % 3 == 0 ? n1 * i : n2 - i));
+    std::cout << window.sum() << " " << window.min() << " " << window.max() << " " << window.size() << std::endl;
 }
 
+#if __cplusplus >= 201703L
 template <class N>
-void orExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+void formatExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
 {
-    N a(n1);
-    N b(n2);
-    std::cout << (a || b) << std::endl;
+    const N values[] = { N(n1), N(n2), N(n1) + N(n2) };
+    std::string text;
+    aop::formatDelimited(values, 3, text, ',');
+    std::vector<N> parsed;
+    aop::parseDelimited(text.data(), text.data() + text.size() - 1, parsed, ',');
+    std::cout << text << " " << parsed.size() << std::endl;
 }
+#endif
 
+#if __cplusplus >= 202002L
 template <class N>
-void bitwiseExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
+void pipelineExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2)
 {
-    N a(n1);
-    N b(n2);
-    std::cout << (a + ((b >>= 1) << 3)) << std::endl;
+    std::istringstream input("1 0 2 0 3 4 0 5");
+    aop::pipeline::Channel<N> parsed(2), scaled(2), kept(2);
+    N total(0);
+    aop::pipeline::Pipeline pipeline(2);
+    pipeline.spawn(aop::pipeline::parse(input, parsed));
+    pipeline.spawn(aop::pipeline::transform(parsed, scaled, [n1](const N& value) { return value << N(n1); }));
+    pipeline.spawn(aop::pipeline::filter(scaled, kept));
+    pipeline.spawn(aop::pipeline::aggregate(kept, total, [](const N& a, const N& b) { return a + b; }));
+    pipeline.run();
+    std::cout << total + N(n2) << std::endl;
 }
+#endif
 
 int main()
 {
@@ -309,6 +425,98 @@ int main()
 
     typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2>::Type, ArithmeticAspect>::Type FloatRoundNumber;
     sumExample<FloatRoundNumber>(1.339, 1.1233);
+    chainExample<FloatRoundNumber>(1.339, 1.1233);
+
+    typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2, Rounding::Deferred>::Type, ArithmeticAspect>::Type FloatDeferredRoundNumber;
+    sumExample<FloatDeferredRoundNumber>(1.339, 1.1233);
+    chainExample<FloatDeferredRoundNumber>(1.339, 1.1233);
+    typedef aop::Decorate<Number<float>::Type>::with<RoundAspect<2, Rounding::Deferred>::Type, RoundAspect<1>::Type, ArithmeticAspect>::Type FloatDeferredOverRoundNumber;
+    chainExample<FloatDeferredOverRoundNumber>(1.339, 1.1233);
+
+    typedef aop::Decorate<Number<float>::Type>::with<CompensatedSumAspect, ArithmeticAspect>::Type FloatSumNumber;
+    compensatedSumExample<FloatSumNumber>(0.1, 0.7);
+
+    typedef aop::Decorate<BitsetNumber<200>::Type>::with<BitwiseAspect>::Type BitsetBitwiseNumber;
+    shiftExample<BitsetBitwiseNumber>(5, 130);
+    bitsetExample<BitsetBitwiseNumber>(5, 12);
+
+    typedef aop::Decorate<Matrix<float, 2, 2>::Type>::with<RoundAspect<2>::Type, ArithmeticAspect>::Type FloatRoundMatrix;
+    matrixExample<FloatRoundMatrix>(1);
+    typedef aop::Decorate<Matrix<float, 3, 3>::Type>::with<FusedAspect, ArithmeticAspect>::Type FusedMatrix;
+    matrixExample<FusedMatrix>(1);
+    typedef aop::Decorate<Matrix<float, 3, 3>::Type>::with<PooledAspect, FusedAspect, ArithmeticAspect>::Type PooledFusedMatrix;
+    matrixExample<PooledFusedMatrix>(1);
+    sumExample<aop::Decorate<Vector<int, 3>::Type>::with<ArithmeticAspect>::Type>(1, 2);
+
+    typedef aop::Decorate<InternNumber<aop::BigInt>::Type>::with<InternAspect, ArithmeticAspect, ComparisonAspect>::Type InternedBigNumber;
+    sumExample<InternedBigNumber>("18446744073709551615", "1");
+    internExample<InternedBigNumber>("340282366920938463463374607431768211456", "18446744073709551616");
+
+    typedef aop::Decorate<Number<int>::Type>::with<CachedDerivedAspect<CountedHash>::Type, ArithmeticAspect, HashAspect>::Type CachedHashNumber;
+    cachedExample<CachedHashNumber>(3, 4);
+    typedef aop::Decorate<Number<int>::Type>::with<CachedDerivedAspect<CountedHash>::Type, IncrementalAspect, HashAspect>::Type CachedIncrementalNumber;
+    CachedIncrementalNumber counter(7);
+    const std::size_t before = counter.derived();
+    counter++;
+    --counter;
+    std::cout << (counter.derived() == before) << " " << CountedHash::computed << std::endl;
+
+    typedef aop::Decorate<Number<unsigned short>::Type>::with<BitwiseAspect>::Type ShortBitwiseNumber;
+    std::cout << ~ShortBitwiseNumber(0x00ff) << " " << ShortBitwiseNumber(0x0f00).popcount() << " " << ShortBitwiseNumber(0x0f00).findFirst() << " " << ShortBitwiseNumber(0).findFirst() << std::endl;
+
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<ArithmeticAspect, PooledAspect>::Type PooledNumber;
+    poolExample<PooledNumber>(1, 2);
+
+    typedef aop::Decorate<Number<aop::ArenaString>::Type>::with<ArithmeticAspect, PooledAspect>::Type PooledString;
+    poolExample<PooledString>("1.", "25");
+
+    typedef aop::Decorate<BigNumber::Type>::with<ArithmeticAspect, BitwiseAspect, LogicalAspect>::Type BigIntegralNumber;
+    sumExample<BigIntegralNumber>("18446744073709551615", "1");
+    shiftExample<BigIntegralNumber>(1, 100);
+    orExample<BigIntegralNumber>(0, "340282366920938463463374607431768211456");
+
+    mixedExample<IntegralNumber>(1, 2);
+    mixedExample<BigIntegralNumber>("18446744073709551615", 2);
+
+    binaryExample<IntegralNumber>(1, 2);
+    binaryExample<FloatRoundNumber>(1.339, 1.1233);
+
+    compressedExample<IntegralNumber>(1000, 7);
+    filterExample<IntegralNumber>(2, 3);
+
+    typedef aop::Decorate<Number<int>::Type>::with<ComparisonAspect, ArithmeticAspect>::Type SortableNumber;
+    sortExample<SortableNumber>(3, 501);
+    mixedComparisonExample<SortableNumber>(3, 5);
+    typedef aop::Decorate<Number<float>::Type>::with<ComparisonAspect, RoundAspect<2>::Type, ArithmeticAspect>::Type SortableFloatNumber;
+    sortExample<SortableFloatNumber>(0.5, 100);
+    heterogeneousExample<SortableNumber, SortableFloatNumber>(3, 1.339);
+    heterogeneousExample<IntegralNumber, SortableFloatNumber>(3, 1.339);
+
+    typedef aop::Decorate<Number<unsigned int>::Type>::with<HashAspect, ComparisonAspect, ArithmeticAspect>::Type KeyNumber;
+    hashExample<KeyNumber>(300, 7);
+
+    parallelExample<IntegralNumber>(1, 2);
+    scanExample<IntegralNumber>(10, 4);
+    windowExample<SortableNumber>(3, 5);
+
+    typedef aop::Decorate<Number<float>::Type>::with<MemoizeAspect<256, 2>::Type, RoundAspect<2>::Type, ArithmeticAspect>::Type MemoizedRoundNumber;
+    memoizeExample<MemoizedRoundNumber>(1.339, 1.1233);
+
+    introspectionExample<IntegralNumber>();
+    introspectionExample<FloatRoundNumber>();
+    std::cout << aop::aspect_at<FloatRoundNumber, aop::aspect_position<FloatRoundNumber, RoundAspect<2>::Type>::value>::Type::Precision << std::endl;
+
+    typedef aop::DynamicDecorate<Number<float>::Type>::among<aop::Aspects<RoundAspect<2>::Type, ArithmeticAspect>, aop::Aspects<ArithmeticAspect> > TenantSemantics;
+    dynamicExample<TenantSemantics>(1.339, 1.1233);
+
+#if __cplusplus >= 201703L
+    formatExample<IntegralNumber>(1, 2);
+    formatExample<FloatRoundNumber>(1.339, 1.1233);
+    formatExample<FloatRoundNumber>(-2.009, 0.5);
+#endif
+#if __cplusplus >= 202002L
+    pipelineExample<IntegralNumber>(2, 1);
+#endif
 
     return 0;
 }
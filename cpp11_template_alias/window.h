@@ -0,0 +1,163 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <cstddef>
+#include <vector>
+
+namespace aop
+{
+
+/*
+* Rolling aggregates over the last CAPACITY values pushed. The values
+* live in a ring buffer allocated once; the sum is kept by
+* subtract-on-evict, so N needs the ArithmeticAspect, and min/max by the
+* two-stack method, so N needs the ComparisonAspect. Each push is
+* amortized O(1).
+*
+* The oldest 'front' values of the ring act as the front stack and keep
+* suffix min/max per slot, the newer ones as the back stack and keep one
+* running min/max. When the front empties the back is flipped into it.
+*/
+template <class N, std::size_t CAPACITY>
+class Window
+{
+public:
+    static const std::size_t Capacity = CAPACITY;
+
+    explicit Window(const N& zero = N(0))
+        : slots(CAPACITY, Slot(zero)), head(0), count(0), front(0), total(zero), zero(zero), backMin(zero), backMax(zero)
+    {}
+
+    void push(const N& value)
+    {
+        if (count == CAPACITY)
+            evict();
+
+        slots[(head + count) % CAPACITY].value = value;
+        total += value;
+        if (count++ == front)
+            backMin = backMax = value;
+        else
+        {
+            if (value < backMin)
+                backMin = value;
+            if (backMax < value)
+                backMax = value;
+        }
+    }
+
+    void clear()
+    {
+        head = count = front = 0;
+        total = zero;
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == CAPACITY; }
+
+    const N& sum() const { return total; }
+
+    // min(), max(), oldest() and newest() need a non empty window.
+    const N& min() const
+    {
+        if (front == 0)
+            return backMin;
+        const N& low = slots[head].min;
+        return count > front && backMin < low ? backMin : low;
+    }
+
+    const N& max() const
+    {
+        if (front == 0)
+            return backMax;
+        const N& high = slots[head].max;
+        return count > front && high < backMax ? backMax : high;
+    }
+
+    const N& oldest() const { return slots[head].value; }
+    const N& newest() const { return slots[(head + count - 1) % CAPACITY].value; }
+
+private:
+    struct Slot
+    {
+        explicit Slot(const N& zero)
+            : value(zero), min(zero), max(zero)
+        {}
+
+        N value;
+        N min;
+        N max;
+    };
+
+    void evict()
+    {
+        if (front == 0)
+            flip();
+        total -= slots[head].value;
+        head = (head + 1) % CAPACITY;
+        --count;
+        --front;
+    }
+
+    void flip()
+    {
+        std::size_t i = (head + count - 1) % CAPACITY;
+        N low = slots[i].value;
+        N high = low;
+        for (std::size_t k = 0; k < count; ++k, i = (i + CAPACITY - 1) % CAPACITY)
+        {
+            Slot& slot = slots[i];
+            if (slot.value < low)
+                low = slot.value;
+            if (high < slot.value)
+                high = slot.value;
+            slot.min = low;
+            slot.max = high;
+        }
+        front = count;
+    }
+
+    std::vector<Slot> slots;
+    std::size_t head;
+    std::size_t count;
+    std::size_t front;
+    N total;
+    N zero;
+    N backMin;
+    N backMax;
+};
+
+}
+
+#endif
@@ -31,21 +31,12 @@
 #ifndef AOP_H
 #define AOP_H
 
+#include <cstddef>
+#include "typelist.h"
+
 namespace aop
 {
 
-#define TYPELIST_1(type) \
-    aop::Typelist<type, aop::NullType>
-
-#define TYPELIST_2(type1, type2) \
-    aop::Typelist<type1, TYPELIST_1(type2) >
-
-#define TYPELIST_3(type1, type2, type3) \
-    aop::Typelist<type1, TYPELIST_2(type2, type3) >
-
-#define TYPELIST_4(type1, type2, type3, type4) \
-    aop::Typelist<type1, TYPELIST_3(type2, type3, type4) >
-
 struct NullType
 {};
 
@@ -76,50 +67,182 @@ struct AspectAopData
     typedef Aspect<A> AspectType;
 };
 
-template <template <template <class> class> class Base>
-struct Decorate
+/*
+* Aspects are bound pairwise: adjacent binders are composed, then the
+* composed ones, so bindings nest log2(n) deep instead of n deep. None
+* of this depends on the base, so every base decorated with the same
+* aspects shares it.
+*/
+template <template <class> class A>
+struct Binder
 {
-    template <template <class> class A, class B = NullType>
-    struct Binder
+    template <class P>
+    struct Binding
     {
-        template <class T>
-        struct Binding
-        {
-            typedef typename Binder<A>::template Binding<typename B::template Binding<T>::Type>::Type Type;
-        };
+        typedef A<P> Type;
     };
+};
 
-    template<template <class> class T>
-    struct Binder<T, NullType>
+template <class Outer, class Inner>
+struct ComposedBinder
+{
+    template <class T>
+    struct Binding
     {
-        template <class P>
-        struct Binding
-        {
-            typedef T<P> Type;
-        };
+        typedef typename Outer::template Binding<typename Inner::template Binding<T>::Type>::Type Type;
     };
+};
 
-    template <class Aspects>
-    struct Apply;
+template <class Head, class Tail>
+struct BinderList
+{};
 
-    template <template <class> class Head>
-    struct Apply<Typelist<Head, NullType> >
-    {
-        typedef Binder<Head> Type;
-    };
+template <class Aspects>
+struct Binders;
 
-    template <template <class> class Head, class Tail>
-    struct Apply<Typelist<Head, Tail> >
-    {
-        typedef Binder<Head, typename Apply<Tail>::Type> Type;
-    };
+template <template <class> class Head>
+struct Binders<Typelist<Head, NullType> >
+{
+    typedef BinderList<Binder<Head>, NullType> Type;
+};
 
+template <template <class> class Head, class Tail>
+struct Binders<Typelist<Head, Tail> >
+{
+    typedef BinderList<Binder<Head>, typename Binders<Tail>::Type> Type;
+};
+
+template <class List>
+struct ComposePairs;
+
+template <class B>
+struct ComposePairs<BinderList<B, NullType> >
+{
+    typedef BinderList<B, NullType> Type;
+};
+
+template <class First, class Second>
+struct ComposePairs<BinderList<First, BinderList<Second, NullType> > >
+{
+    typedef BinderList<ComposedBinder<First, Second>, NullType> Type;
+};
+
+template <class First, class Second, class Rest>
+struct ComposePairs<BinderList<First, BinderList<Second, Rest> > >
+{
+    typedef BinderList<ComposedBinder<First, Second>, typename ComposePairs<Rest>::Type> Type;
+};
+
+template <class List>
+struct ComposeAll
+{
+    typedef typename ComposeAll<typename ComposePairs<List>::Type>::Type Type;
+};
+
+template <class B>
+struct ComposeAll<BinderList<B, NullType> >
+{
+    typedef B Type;
+};
+
+template <template <template <class> class> class Base>
+struct Decorate
+{
     template<class Aspects>
     struct with
     {
-        typedef typename Apply<Aspects>::Type TypeP;
+        typedef typename ComposeAll<typename Binders<Aspects>::Type>::Type TypeP;
         typedef typename TypeP::template Binding<Base<TypeP::template Binding> >::Type Type;
     };
 };
+
+/*
+* Compile-time introspection. A decorated type is its aspects wrapped
+* around each other, outermost first: every layer is some Aspect<Inner>
+* while the base, taking a template, never is. Configuration parameters
+* are the static members of a layer, e.g. aspect_at<N, I>::Type::Precision.
+*/
+template <template <class> class A, template <class> class B>
+struct same_aspect
+{
+    static const bool value = false;
+};
+
+template <template <class> class A>
+struct same_aspect<A, A>
+{
+    static const bool value = true;
+};
+
+template <class N>
+struct aspect_count
+{
+    static const std::size_t value = 0;
+};
+
+template <template <class> class Layer, class Inner>
+struct aspect_count<Layer<Inner> >
+{
+    static const std::size_t value = 1 + aspect_count<Inner>::value;
+};
+
+template <class N, std::size_t I>
+struct aspect_at;
+
+template <template <class> class Layer, class Inner>
+struct aspect_at<Layer<Inner>, 0>
+{
+    typedef Layer<Inner> Type;
+};
+
+template <template <class> class Layer, class Inner, std::size_t I>
+struct aspect_at<Layer<Inner>, I> : aspect_at<Inner, I - 1>
+{};
+
+// Index of Aspect counting from the outermost layer, -1 when absent.
+template <class N, template <class> class Aspect>
+struct aspect_position
+{
+    static const int value = -1;
+};
+
+template <template <class> class Layer, class Inner, template <class> class Aspect>
+struct aspect_position<Layer<Inner>, Aspect>
+{
+    static const int value = same_aspect<Layer, Aspect>::value ? 0
+        : aspect_position<Inner, Aspect>::value < 0 ? -1 : 1 + aspect_position<Inner, Aspect>::value;
+};
+
+template <class N, template <class> class Aspect>
+struct has_aspect
+{
+    static const bool value = aspect_position<N, Aspect>::value >= 0;
+};
+
+// Whether Pred<Aspect>::value holds for every aspect of N.
+template <class N, template <template <class> class> class Pred>
+struct all_aspects
+{
+    static const bool value = true;
+};
+
+template <template <class> class Layer, class Inner, template <template <class> class> class Pred>
+struct all_aspects<Layer<Inner>, Pred>
+{
+    static const bool value = Pred<Layer>::value && all_aspects<Inner, Pred>::value;
+};
+
+// The Typelist such that with<> of it gives N back.
+template <class N>
+struct aspect_list
+{
+    typedef NullType Type;
+};
+
+template <template <class> class Layer, class Inner>
+struct aspect_list<Layer<Inner> >
+{
+    typedef Typelist<Layer, typename aspect_list<Inner>::Type> Type;
+};
 }
 #endif
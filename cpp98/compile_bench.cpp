@@ -0,0 +1,242 @@
+/*
+    Copyright (C) 2011-2012 Hugo Arregui
+
+    This file is part of the "CPP: AOP + CRTP" Library.
+
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in the
+       documentation and/or other materials provided with the distribution.
+    3. The name of the authors may not be used to endorse or promote products
+       derived from this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+    IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+    OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+    IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+    NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+    THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+* Compile-time benchmark: trivial aspects stacked ASPECTS deep on eight
+* bases, ASPECTS being 8, 16, 32 or 64. make compile_bench reports the
+* time and memory g++ needs for each, with Decorate's pairwise binding
+* and, under LINEAR_APPLY, the linear one it replaced.
+*/
+
+#include "aop.h"
+
+#ifndef ASPECTS
+#define ASPECTS 64
+#endif
+
+template <class T>
+struct Number
+{
+    template <template <class> class A = aop::NullAspect>
+    class Type
+    {
+    public:
+        typedef T UnderlyingType;
+        typedef aop::BaseAopData<Number::Type, A> AopData;
+        typedef typename AopData::Type FullType;
+
+        Type(UnderlyingType n)
+            : n(n)
+        {}
+
+        UnderlyingType value() const
+        {
+            return n;
+        }
+    protected:
+        UnderlyingType n;
+    };
+};
+
+#define BENCH_ASPECT(I) \
+    template <class A> \
+    class Aspect##I: public A \
+    { \
+    public: \
+        typedef typename A::FullType FullType; \
+        Aspect##I(typename A::UnderlyingType n) \
+            : A(n) \
+        {} \
+        Aspect##I(const A& a) \
+            : A(a) \
+        {} \
+        FullType step##I() const \
+        { \
+            return FullType(A::n + I); \
+        } \
+    };
+
+BENCH_ASPECT(1)
+BENCH_ASPECT(2)
+BENCH_ASPECT(3)
+BENCH_ASPECT(4)
+BENCH_ASPECT(5)
+BENCH_ASPECT(6)
+BENCH_ASPECT(7)
+BENCH_ASPECT(8)
+BENCH_ASPECT(9)
+BENCH_ASPECT(10)
+BENCH_ASPECT(11)
+BENCH_ASPECT(12)
+BENCH_ASPECT(13)
+BENCH_ASPECT(14)
+BENCH_ASPECT(15)
+BENCH_ASPECT(16)
+BENCH_ASPECT(17)
+BENCH_ASPECT(18)
+BENCH_ASPECT(19)
+BENCH_ASPECT(20)
+BENCH_ASPECT(21)
+BENCH_ASPECT(22)
+BENCH_ASPECT(23)
+BENCH_ASPECT(24)
+BENCH_ASPECT(25)
+BENCH_ASPECT(26)
+BENCH_ASPECT(27)
+BENCH_ASPECT(28)
+BENCH_ASPECT(29)
+BENCH_ASPECT(30)
+BENCH_ASPECT(31)
+BENCH_ASPECT(32)
+BENCH_ASPECT(33)
+BENCH_ASPECT(34)
+BENCH_ASPECT(35)
+BENCH_ASPECT(36)
+BENCH_ASPECT(37)
+BENCH_ASPECT(38)
+BENCH_ASPECT(39)
+BENCH_ASPECT(40)
+BENCH_ASPECT(41)
+BENCH_ASPECT(42)
+BENCH_ASPECT(43)
+BENCH_ASPECT(44)
+BENCH_ASPECT(45)
+BENCH_ASPECT(46)
+BENCH_ASPECT(47)
+BENCH_ASPECT(48)
+BENCH_ASPECT(49)
+BENCH_ASPECT(50)
+BENCH_ASPECT(51)
+BENCH_ASPECT(52)
+BENCH_ASPECT(53)
+BENCH_ASPECT(54)
+BENCH_ASPECT(55)
+BENCH_ASPECT(56)
+BENCH_ASPECT(57)
+BENCH_ASPECT(58)
+BENCH_ASPECT(59)
+BENCH_ASPECT(60)
+BENCH_ASPECT(61)
+BENCH_ASPECT(62)
+BENCH_ASPECT(63)
+BENCH_ASPECT(64)
+
+#define ASPECTS_8 Aspect1, Aspect2, Aspect3, Aspect4, Aspect5, Aspect6, Aspect7, Aspect8
+#define ASPECTS_16 ASPECTS_8, Aspect9, Aspect10, Aspect11, Aspect12, Aspect13, Aspect14, Aspect15, Aspect16
+#define ASPECTS_32 ASPECTS_16, Aspect17, Aspect18, Aspect19, Aspect20, Aspect21, Aspect22, Aspect23, Aspect24, Aspect25, Aspect26, Aspect27, Aspect28, Aspect29, Aspect30, Aspect31, Aspect32
+#define ASPECTS_64 ASPECTS_32, Aspect33, Aspect34, Aspect35, Aspect36, Aspect37, Aspect38, Aspect39, Aspect40, Aspect41, Aspect42, Aspect43, Aspect44, Aspect45, Aspect46, Aspect47, Aspect48, Aspect49, Aspect50, Aspect51, Aspect52, Aspect53, Aspect54, Aspect55, Aspect56, Aspect57, Aspect58, Aspect59, Aspect60, Aspect61, Aspect62, Aspect63, Aspect64
+
+// Expands the list before TYPELIST_n counts its arguments.
+#define CALL(macro, arguments) macro arguments
+
+#if ASPECTS == 8
+#define BENCH_LIST CALL(TYPELIST_8, (ASPECTS_8))
+#elif ASPECTS == 16
+#define BENCH_LIST CALL(TYPELIST_16, (ASPECTS_16))
+#elif ASPECTS == 32
+#define BENCH_LIST CALL(TYPELIST_32, (ASPECTS_32))
+#else
+#define BENCH_LIST CALL(TYPELIST_64, (ASPECTS_64))
+#endif
+
+#ifdef LINEAR_APPLY
+/*
+* The linear binding Decorate used before, as a baseline: every binder
+* wraps the next one, so bindings nest ASPECTS deep.
+*/
+namespace linear
+{
+using aop::NullType;
+using aop::Typelist;
+
+template <template <template <class> class> class Base>
+struct Decorate
+{
+    template <template <class> class A, class B = NullType>
+    struct Binder
+    {
+        template <class T>
+        struct Binding
+        {
+            typedef typename Binder<A>::template Binding<typename B::template Binding<T>::Type>::Type Type;
+        };
+    };
+
+    template<template <class> class T>
+    struct Binder<T, NullType>
+    {
+        template <class P>
+        struct Binding
+        {
+            typedef T<P> Type;
+        };
+    };
+
+    template <class Aspects>
+    struct Apply;
+
+    template <template <class> class Head>
+    struct Apply<Typelist<Head, NullType> >
+    {
+        typedef Binder<Head> Type;
+    };
+
+    template <template <class> class Head, class Tail>
+    struct Apply<Typelist<Head, Tail> >
+    {
+        typedef Binder<Head, typename Apply<Tail>::Type> Type;
+    };
+
+    template<class Aspects>
+    struct with
+    {
+        typedef typename Apply<Aspects>::Type TypeP;
+        typedef typename TypeP::template Binding<Base<TypeP::template Binding> >::Type Type;
+    };
+};
+}
+#define BENCH_DECORATE linear::Decorate
+#else
+#define BENCH_DECORATE aop::Decorate
+#endif
+
+template <class T>
+T use(T seed)
+{
+    typedef typename BENCH_DECORATE<Number<T>::template Type>::template with<BENCH_LIST>::Type N;
+    const N n(seed);
+    return n.step1().step8().value();
+}
+
+int main()
+{
+    return int(use<char>(1) + use<signed char>(1) + use<unsigned char>(1) + use<short>(1)
+               + use<unsigned short>(1) + use<int>(1) + use<unsigned int>(1) + use<long>(1)) & 1;
+}
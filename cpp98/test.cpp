@@ -152,6 +152,7 @@ struct RoundAspect
     public:
         typedef aop::AspectAopData< RoundAspect::Type, A> AopData;
         typedef typename AopData::Type FullType;
+        static const unsigned int Precision = PRECISION;
 
         Type(typename A::UnderlyingType n)
             : A(n)
@@ -279,6 +280,13 @@ void bitwiseExample(typename N::UnderlyingType n1, typename N::UnderlyingType n2
     std::cout << (a + ((b >>= 1) << 3)) << std::endl;
 }
 
+template <class N>
+void introspectionExample()
+{
+    std::cout << aop::aspect_count<N>::value << " " << aop::has_aspect<N, BitwiseAspect>::value << " "
+              << aop::aspect_position<N, ArithmeticAspect>::value << std::endl;
+}
+
 int main()
 {
     typedef aop::Decorate<Number<unsigned int>::Type>::with<
@@ -293,5 +301,14 @@ int main()
     typedef aop::Decorate<Number<int>::Type>::with<TYPELIST_1(LogicalAspect)>::Type IntLogicalNumber;
     orExample<IntLogicalNumber>(1, 0);
 
+    typedef aop::Decorate<Number<float>::Type>::with<
+        TYPELIST_4(RoundAspect<2>::Type, LogicalAspect, ArithmeticAspect, IncrementalAspect)>::Type FloatRoundIncrementalNumber;
+    sumExample<FloatRoundIncrementalNumber>(1.339, 1.1233);
+
+    introspectionExample<IntegralNumber>();
+    introspectionExample<FloatRoundLogicalNumber>();
+    introspectionExample<FloatRoundIncrementalNumber>();
+    std::cout << aop::aspect_at<FloatRoundLogicalNumber, aop::aspect_position<FloatRoundLogicalNumber, RoundAspect<2>::Type>::value>::Type::Precision << std::endl;
+
     return 0;
 }